@@ -23,7 +23,8 @@ OTHER DEALINGS IN THE SOFTWARE.
 // create_random_chain() and chase_pointers() are from
 // https://github.com/afborchert/pointer-chasing
 // with a few adjustments:
-// - `std::shuffle` instead of manual shuffling
+// - a single cycle over the whole chain, linked in the order of a random
+//   permutation shuffled in parallel
 // - lambda
 //
 // https://github.com/afborchert/pointer-chasing
@@ -55,27 +56,50 @@ OTHER DEALINGS IN THE SOFTWARE.
 #include "argh.h"
 #define ANKERL_NANOBENCH_IMPLEMENT
 #include "nanobench.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#include <linux/futex.h>
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <cctype>
+#include <cerrno>
 #include <chrono>
 #include <climits>
 #include <cmath>
+#include <condition_variable>
 #include <csignal>
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <numeric>
+#include <new>
 #include <random>
+#include <set>
+#include <shared_mutex>
 #include <sstream>
 #include <string>
 #include <thread>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #define S(x) (#x)
@@ -99,7 +123,14 @@ static constexpr size_t MiB = KiB * KiB;
 // https://www.gnu.org/software/libc/manual/html_mono/libc.html#Constants-for-Sysconf
 static const size_t PAGESIZE = sysconf(_SC_PAGESIZE);
 static const size_t L1_cache_size = sysconf(_SC_LEVEL1_DCACHE_SIZE);
-static const size_t cache_line_size = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+// sysconf(name), or fallback if glibc does not know it (0 or -1): for values
+// used as strides and divisors.
+static size_t sysconf_or(const int name, const size_t fallback) {
+  const auto value = sysconf(name);
+  return value > 0 ? static_cast<size_t>(value) : fallback;
+}
+static const size_t cache_line_size =
+    sysconf_or(_SC_LEVEL1_DCACHE_LINESIZE, 64);
 static const size_t L2_cache_size = sysconf(_SC_LEVEL2_CACHE_SIZE);
 static const size_t L3_cache_size = sysconf(_SC_LEVEL3_CACHE_SIZE);
 // XXX is 1GiB enough on Zen2 EPYC and such "large" cpus?
@@ -109,8 +140,3896 @@ static const size_t memory_chunk =
                256 * MiB,
                1024 * MiB);
 
-static std::mutex m;
-static int mi = 0;
+static std::mutex m;
+static int mi = 0;
+
+// hint to the core that the caller spin-waits: yields to an SMT sibling and
+// keeps the spinning loads from flooding the memory system.
+static inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+static double v(const ankerl::nanobench::Result& r, const std::string& s) {
+  return r.median(r.fromString(s));
+}
+
+static double cpucycles_per_element(const ankerl::nanobench::Result& r,
+                                    const size_t element_count) {
+  return v(r, "cpucycles") / element_count;
+}
+
+static double cpucycles_per_element(const ankerl::nanobench::Bench& b,
+                                    const size_t element_count) {
+  auto cpucycles = 0.0;
+  for (auto& x : b.results()) {
+    cpucycles += cpucycles_per_element(x, element_count);
+  }
+  return cpucycles / b.results().size();
+}
+
+static double latency_per_element(const ankerl::nanobench::Result& r,
+                                  const size_t element_count) {
+  return v(r, "elapsed") *
+         std::chrono::nanoseconds(std::chrono::seconds(1)).count() /
+         element_count;
+}
+
+static double latency_per_element(const ankerl::nanobench::Bench& b,
+                                  const size_t element_count) {
+  auto latency = 0.0;
+  for (auto& x : b.results()) {
+    latency += latency_per_element(x, element_count);
+  }
+  return latency / b.results().size();
+}
+
+// "4096", "48KiB", "48k", "2MiB", "1G" -> bytes; 0 if s is malformed,
+// negative or too large.
+static size_t parse_size(const std::string& s) {
+  char* unit;
+  const double n = std::strtod(s.c_str(), &unit);
+  double bytes;
+  switch (std::tolower(static_cast<unsigned char>(*unit))) {
+    case '\0':
+      bytes = n;
+      break;
+    case 'k':
+      bytes = n * KiB;
+      break;
+    case 'm':
+      bytes = n * MiB;
+      break;
+    case 'g':
+      bytes = n * KiB * MiB;
+      break;
+    default:
+      return 0;
+  }
+  // 2^64 as a double; anything from there on does not fit a size_t.
+  if (!std::isfinite(bytes) || bytes < 0 || bytes >= 0x1p64) {
+    return 0;
+  }
+  return bytes;
+}
+
+// bytes -> "4KiB", "5.66MiB", "1GiB".
+static std::string size_string(const size_t bytes) {
+  static const char* units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+  double n = bytes;
+  size_t u = 0;
+  while (n >= KiB && u < std::size(units) - 1) {
+    n /= KiB;
+    ++u;
+  }
+  char s[32];
+  ::snprintf(s, sizeof s, "%.3g%s", n, units[u]);
+  return s;
+}
+
+// --name=SIZE, or default_size if absent or malformed.
+static size_t size_param(const argh::parser& cmdline, const char* name,
+                         const size_t default_size) {
+  std::string s;
+  if (!(cmdline(name) >> s)) {
+    return default_size;
+  }
+  const auto size = parse_size(s);
+  return size != 0 ? size : default_size;
+}
+
+// print ns and, if hardware performance counters are readable, cycles;
+// and the working set reachable by the measured chain if it is given.
+static void print_ns_cyc(const std::string& name, const double ns,
+                         const double cycles, const size_t reachable = 0) {
+  if (std::isnormal(cycles)) {
+    ::printf("%-30s %10.1f ns %10.1f cycles", name.c_str(), ns, cycles);
+  } else {
+    ::printf("%-30s %10.1f ns", name.c_str(), ns);
+  }
+  if (reachable != 0) {
+    ::printf(" %10s reachable", size_string(reachable).c_str());
+  }
+  ::printf("\n");
+}
+
+// backing pages of pointer chains:
+// standard: whatever operator new and the kernel defaults give;
+// small: 4KiB pages, transparent huge pages disabled by madvise(2);
+// thp: transparent huge pages requested by madvise(2);
+// huge_2MiB, huge_1GiB: explicit hugetlb mappings, which need pages reserved
+// in /sys/kernel/mm/hugepages/hugepages-*/nr_hugepages.
+enum class pages { standard, small, thp, huge_2MiB, huge_1GiB };
+
+static size_t page_size(const pages backing) {
+  switch (backing) {
+    case pages::thp:
+    case pages::huge_2MiB:
+      return 2 * MiB;
+    case pages::huge_1GiB:
+      return KiB * MiB;
+    default:
+      return PAGESIZE;
+  }
+}
+
+static std::string pages_string(const pages backing) {
+  switch (backing) {
+    case pages::standard:
+      return "default";
+    case pages::thp:
+      return "thp";
+    default:
+      return size_string(page_size(backing));
+  }
+}
+
+// allocator of std::vector backed by mmap(2) with the given pages.
+template <typename T>
+struct page_allocator {
+  using value_type = T;
+  pages backing = pages::standard;
+
+  page_allocator() = default;
+  explicit page_allocator(const pages p) : backing(p) {}
+  template <typename U>
+  page_allocator(const page_allocator<U>& other) : backing(other.backing) {}
+
+  size_t mapped(const size_t n) const {
+    const auto size = page_size(backing);
+    return (n * sizeof(T) + size - 1) / size * size;
+  }
+
+  T* allocate(const size_t n) {
+    if (backing == pages::standard) {
+      return std::allocator<T>().allocate(n);
+    }
+    const auto length = mapped(n);
+    // hugetlb mappings reserve their pages, so that mmap(2) fails when too
+    // few are free instead of the first touch raising SIGBUS.
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    if (backing == pages::huge_2MiB) {
+      flags |= MAP_HUGETLB | (21 << MAP_HUGE_SHIFT);
+    } else if (backing == pages::huge_1GiB) {
+      flags |= MAP_HUGETLB | (30 << MAP_HUGE_SHIFT);
+    } else {
+      flags |= MAP_NORESERVE;
+    }
+    // thp needs 2MiB-aligned memory: map more and trim the slack.
+    const auto slack = backing == pages::thp ? page_size(backing) : 0;
+    auto q = ::mmap(nullptr, length + slack, PROT_READ | PROT_WRITE, flags, -1,
+                    0);
+    if (q == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    auto head = reinterpret_cast<uintptr_t>(q);
+    if (slack != 0) {
+      const auto aligned = (head + slack - 1) / slack * slack;
+      if (aligned != head) {
+        ::munmap(q, aligned - head);
+      }
+      if (aligned + length != head + length + slack) {
+        ::munmap(reinterpret_cast<void*>(aligned + length),
+                 head + slack - aligned);
+      }
+      head = aligned;
+    }
+    if (backing == pages::small) {
+      ::madvise(reinterpret_cast<void*>(head), length, MADV_NOHUGEPAGE);
+    } else if (backing == pages::thp) {
+      ::madvise(reinterpret_cast<void*>(head), length, MADV_HUGEPAGE);
+    }
+    return reinterpret_cast<T*>(head);
+  }
+
+  // resize() leaves new elements uninitialized instead of zeroing them, so
+  // that pages are first touched by whoever fills them.
+  template <typename U>
+  void construct(U* p) noexcept {
+    ::new (static_cast<void*>(p)) U;
+  }
+  template <typename U, typename... Args>
+  void construct(U* p, Args&&... args) {
+    ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+  }
+
+  void deallocate(T* q, const size_t n) {
+    if (backing == pages::standard) {
+      std::allocator<T>().deallocate(q, n);
+    } else {
+      ::munmap(q, mapped(n));
+    }
+  }
+
+  template <typename U>
+  bool operator==(const page_allocator<U>& other) const {
+    return backing == other.backing;
+  }
+  template <typename U>
+  bool operator!=(const page_allocator<U>& other) const {
+    return backing != other.backing;
+  }
+};
+
+using chain = std::vector<void*, page_allocator<void*>>;
+
+// --pages=4KiB|thp|2MiB|1GiB, or pages::standard.  Parsed once: hugetlb
+// pages fall back to 4KiB pages, with a warning, unless memory_chunk of them
+// can be mapped.
+static pages pages_param(const argh::parser& cmdline) {
+  static const auto backing = [&] {
+    std::string s;
+    if (!(cmdline("--pages") >> s)) {
+      return pages::standard;
+    }
+    if (s == "thp") {
+      return pages::thp;
+    }
+    auto parsed = pages::standard;
+    switch (parse_size(s)) {
+      case 4 * KiB:
+        return pages::small;
+      case 2 * MiB:
+        parsed = pages::huge_2MiB;
+        break;
+      case KiB * MiB:
+        parsed = pages::huge_1GiB;
+        break;
+      default:
+        ::fprintf(stderr, "warning: ignoring --pages=%s.\n", s.c_str());
+        return pages::standard;
+    }
+    try {
+      page_allocator<char> allocator{parsed};
+      allocator.deallocate(allocator.allocate(memory_chunk), memory_chunk);
+    } catch (const std::bad_alloc&) {
+      ::fprintf(stderr,
+                "warning: too few free %s pages for %s (see "
+                "/sys/kernel/mm/hugepages/); using 4KiB pages.\n",
+                s.c_str(), size_string(memory_chunk).c_str());
+      return pages::small;
+    }
+    return parsed;
+  }();
+  return backing;
+}
+
+// pages of the mapping containing q, according to /proc/self/smaps: its
+// size, its kernel page size (of hugetlb pages), and bytes of it on
+// transparent huge pages.
+struct pages_in_use {
+  size_t size = 0;
+  size_t page = PAGESIZE;
+  size_t thp = 0;
+};
+
+static pages_in_use smaps_pages(const void* q) {
+  std::ifstream smaps("/proc/self/smaps");
+  const auto address = reinterpret_cast<uintptr_t>(q);
+  auto found = false;
+  pages_in_use used;
+  for (std::string line; std::getline(smaps, line);) {
+    uintptr_t begin, end;
+    char dash;
+    std::istringstream fields(line);
+    if (fields >> std::hex >> begin >> dash >> end && dash == '-') {
+      if (found) {
+        break;
+      }
+      found = begin <= address && address < end;
+      continue;
+    }
+    if (!found) {
+      continue;
+    }
+    std::string key;
+    size_t kB;
+    fields.clear();
+    fields.seekg(0);
+    fields >> key >> std::dec >> kB;
+    if (key == "Size:") {
+      used.size = kB * KiB;
+    } else if (key == "KernelPageSize:") {
+      used.page = kB * KiB;
+    } else if (key == "AnonHugePages:") {
+      used.thp = kB * KiB;
+    }
+  }
+  return used;
+}
+
+// bytes of the mapping containing q that are backed by pages larger than
+// PAGESIZE.
+static size_t huge_page_bytes(const void* q) {
+  const auto used = smaps_pages(q);
+  return used.page > PAGESIZE ? used.size : used.thp;
+}
+
+// the pages actually backing the mapping containing q, touched already:
+// "2MiB", "4KiB", "thp", or "thp (40%), 4KiB" when only part of it got
+// transparent huge pages.  What was asked for may have fallen back.
+static std::string pages_used_string(const void* q) {
+  const auto used = smaps_pages(q);
+  if (used.page > PAGESIZE || used.thp == 0 || used.size == 0) {
+    return size_string(used.page);
+  }
+  if (used.thp >= used.size) {
+    return "thp";
+  }
+  return "thp (" + std::to_string(used.thp * 100 / used.size) + "%), " +
+         size_string(used.page);
+}
+
+// load a pointer, dereference it to go to the next in the list; repeat
+// memory.size() times.
+static void* chase_pointers(void* const* x, size_t count) {
+  while (count--) {
+    x = reinterpret_cast<void* const*>(*x);
+  }
+  return *x;
+}
+
+static void* chase_pointers(const chain& memory) {
+  return chase_pointers(&memory[0], memory.size());
+}
+
+// nodes at hops 0, n/samples, 2n/samples, ... of the cycle from memory[0].
+static std::vector<void* const*> sample_chain(const chain& memory,
+                                              const size_t samples) {
+  std::vector<void* const*> nodes;
+  auto x = &memory[0];
+  for (size_t hop = 0; nodes.size() < samples; ++hop) {
+    if (hop * samples >= nodes.size() * memory.size()) {
+      nodes.push_back(x);
+    }
+    x = reinterpret_cast<void* const*>(*x);
+  }
+  return nodes;
+}
+
+// chase K chains in lockstep from starts[0..K-1], count hops each.
+// The loads of different chains are independent, and the CPU may have up to
+// K cache misses outstanding at once.
+template <size_t K>
+static void* chase_chains(void* const* const* starts, size_t count) {
+  std::array<void* const*, K> x;
+  std::copy_n(starts, K, x.begin());
+  while (count--) {
+    for (auto& y : x) {
+      y = reinterpret_cast<void* const*>(*y);
+    }
+  }
+  uintptr_t z = 0;
+  for (const auto y : x) {
+    z ^= reinterpret_cast<uintptr_t>(*y);
+  }
+  return reinterpret_cast<void*>(z);
+}
+
+static constexpr size_t max_chains = 32;
+using chase_chains_fn = void* (*)(void* const* const*, size_t);
+
+template <size_t... K>
+static constexpr std::array<chase_chains_fn, sizeof...(K)> chase_chains_table(
+    std::index_sequence<K...>) {
+  return {chase_chains<K + 1>...};
+}
+
+// chase_chains_by_count[K - 1] chases K chains.
+static constexpr auto chase_chains_by_count =
+    chase_chains_table(std::make_index_sequence<max_chains>{});
+
+// link nodes, pointers scattered anywhere, into a single cycle visiting them
+// in the order of a random permutation (Fisher-Yates).
+static void link_random_cycle(std::vector<void**>& nodes) {
+  ankerl::nanobench::Rng rng{std::random_device{}()};
+  for (size_t i = nodes.size() - 1; i > 0; --i) {
+    std::swap(nodes[i], nodes[rng.bounded(static_cast<uint32_t>(i + 1))]);
+  }
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    *nodes[i] = nodes[(i + 1) % nodes.size()];
+  }
+}
+
+// untouched, page-aligned memory of the given pages (4KiB pages for
+// pages::standard), unmapped at scope exit.
+struct mapping {
+  page_allocator<char> allocator;
+  size_t size;
+  char* data;
+
+  explicit mapping(const size_t bytes, const pages backing = pages::small)
+      : allocator(backing == pages::standard ? pages::small : backing),
+        size(bytes),
+        data(allocator.allocate(bytes)) {}
+  ~mapping() { allocator.deallocate(data, size); }
+  mapping(const mapping&) = delete;
+  mapping& operator=(const mapping&) = delete;
+};
+
+// log-spaced values from min to max, points_per_octave values per doubling,
+// rounded down to multiples of granularity.
+static std::vector<size_t> log_spaced(const size_t min, const size_t max,
+                                      const size_t points_per_octave,
+                                      const size_t granularity) {
+  std::vector<size_t> xs;
+  for (size_t i = 0;; ++i) {
+    auto x = static_cast<size_t>(
+        min * std::exp2(static_cast<double>(i) / points_per_octave));
+    x -= x % granularity;
+    if (x > max) {
+      break;
+    }
+    if (xs.empty() || xs.back() != x) {
+      xs.push_back(x);
+    }
+  }
+  return xs;
+}
+
+// --points-per-octave=N, or default_points.
+static size_t points_per_octave_param(const argh::parser& cmdline,
+                                      const size_t default_points) {
+  size_t points;
+  cmdline("--points-per-octave", default_points) >> points;
+  return std::clamp(points, size_t{1}, size_t{16});
+}
+
+// A knee is where latency ns[i] rises by more than knee_ratio between
+// neighbouring xs[i]: the last x before the rise approximates a capacity.
+// Consecutive rising steps make one knee.
+static constexpr double knee_ratio = 1.2;
+
+// knees of ns as {last i before the rise, i at its top}.
+static std::vector<std::pair<size_t, size_t>> find_knees(
+    const std::vector<double>& ns) {
+  std::vector<std::pair<size_t, size_t>> knees;
+  for (size_t i = 1; i < ns.size(); ++i) {
+    if (ns[i] <= ns[i - 1] * knee_ratio) {
+      continue;
+    }
+    auto j = i;
+    while (j + 1 < ns.size() && ns[j + 1] > ns[j] * knee_ratio) {
+      ++j;
+    }
+    knees.emplace_back(i - 1, j);
+    i = j;
+  }
+  return knees;
+}
+
+static void print_knees(const std::vector<std::string>& xs,
+                        const std::vector<double>& ns) {
+  ::printf("\nknees (latency rising by more than %.0f%% per step):\n",
+           (knee_ratio - 1) * 100);
+  for (const auto& [i, j] : find_knees(ns)) {
+    ::printf("%-30s %10.1f ns -> %.1f ns at %s\n", ("knee_" + xs[i]).c_str(),
+             ns[i], ns[j], xs[j].c_str());
+  }
+}
+
+// L1, L2, L3 whose sizes glibc knows, and "memory".
+struct level {
+  std::string name;
+  size_t size;
+};
+
+static std::vector<level> levels() {
+  std::vector<level> ls;
+  for (const auto& l : {level{"L1", L1_cache_size}, level{"L2", L2_cache_size},
+                        level{"L3", L3_cache_size},
+                        level{"memory", memory_chunk}}) {
+    if (l.size != 0) {
+      ls.push_back(l);
+    }
+  }
+  return ls;
+}
+
+// first line of a (sysfs) file, or "" if it cannot be read.
+static std::string read_line(const fs::path& path) {
+  std::ifstream f(path);
+  std::string line;
+  std::getline(f, line);
+  return line;
+}
+
+// "0-3,8,10-11" -> {0, 1, 2, 3, 8, 10, 11}
+static std::vector<int> parse_cpulist(const std::string& list) {
+  std::vector<int> ids;
+  std::istringstream ranges(list);
+  for (std::string range; std::getline(ranges, range, ',');) {
+    int first, last;
+    char dash;
+    std::istringstream r(range);
+    if (!(r >> first)) {
+      continue;
+    }
+    last = r >> dash >> last && dash == '-' ? last : first;
+    for (auto id = first; id <= last; ++id) {
+      ids.push_back(id);
+    }
+  }
+  return ids;
+}
+
+// "a,b,c" -> {"a", "b", "c"}
+static std::vector<std::string> split(const std::string& s) {
+  std::vector<std::string> words;
+  std::istringstream ws(s);
+  for (std::string w; std::getline(ws, w, ',');) {
+    words.push_back(w);
+  }
+  return words;
+}
+
+// a logical CPU and where it sits, from /sys/devices/system/cpu/cpu*/.
+struct cpu {
+  int id;
+  int package;
+  int die;
+  int core;
+  int l3;  // id of the L3 it shares, or its package's if sysfs has none
+  int node;
+};
+
+// CPUs this process may run on, or --cpus=LIST of them.
+static std::vector<cpu> cpus(const argh::parser& cmdline) {
+  std::vector<int> nodes_of(CPU_SETSIZE, 0);
+  std::error_code ec;
+  for (const auto& entry :
+       fs::directory_iterator("/sys/devices/system/node", ec)) {
+    const auto name = entry.path().filename().string();
+    if (name.rfind("node", 0) == 0 && std::isdigit(name[4])) {
+      for (const auto id : parse_cpulist(read_line(entry.path() / "cpulist"))) {
+        if (id < CPU_SETSIZE) {
+          nodes_of[id] = std::stoi(name.substr(4));
+        }
+      }
+    }
+  }
+  std::vector<int> ids;
+  std::string list;
+  if (cmdline("--cpus") >> list) {
+    ids = parse_cpulist(list);
+  } else {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    ::sched_getaffinity(0, sizeof set, &set);
+    for (int id = 0; id < CPU_SETSIZE; ++id) {
+      if (CPU_ISSET(id, &set)) {
+        ids.push_back(id);
+      }
+    }
+  }
+  std::vector<cpu> cs;
+  for (const auto id : ids) {
+    if (id < 0 || id >= CPU_SETSIZE) {
+      continue;
+    }
+    const fs::path sys =
+        "/sys/devices/system/cpu/cpu" + std::to_string(id);
+    auto number = [&](const fs::path& path, const int otherwise) {
+      const auto line = read_line(sys / path);
+      return line.empty() ? otherwise : std::stoi(line);
+    };
+    const auto package = number("topology/physical_package_id", 0);
+    cs.push_back({id, package, number("topology/die_id", 0),
+                  number("topology/core_id", id),
+                  number("cache/index3/id", package), nodes_of[id]});
+  }
+  return cs;
+}
+
+// compact: fill a package, an L3, a core (SMT siblings) before the next;
+// scatter: spread over packages, then L3s, then cores, SMT siblings last.
+static std::vector<cpu> placement(std::vector<cpu> cs, const bool scatter) {
+  auto key = [](const cpu& c) {
+    return std::make_tuple(c.package, c.die, c.l3, c.core, c.id);
+  };
+  std::sort(cs.begin(), cs.end(),
+            [&](const cpu& x, const cpu& y) { return key(x) < key(y); });
+  if (!scatter) {
+    return cs;
+  }
+  // order by rank among SMT siblings, rank of the core in its L3, rank of the
+  // L3 in its package, then package.
+  std::map<std::tuple<int, int, int>, long> smt_ranks;
+  std::map<std::tuple<int, int>, std::set<int>> cores_of_l3;
+  std::map<int, std::set<int>> l3s_of_package;
+  for (const auto& c : cs) {
+    cores_of_l3[{c.package, c.l3}].insert(c.core);
+    l3s_of_package[c.package].insert(c.l3);
+  }
+  auto rank = [](const std::set<int>& xs, const int x) {
+    return std::distance(xs.begin(), xs.find(x));
+  };
+  std::vector<std::pair<std::tuple<long, long, long, int>, cpu>> order;
+  for (const auto& c : cs) {
+    order.push_back({{smt_ranks[{c.package, c.die, c.core}]++,
+                      rank(cores_of_l3[{c.package, c.l3}], c.core),
+                      rank(l3s_of_package[c.package], c.l3), c.package},
+                     c});
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [](const auto& x, const auto& y) { return x.first < y.first; });
+  cs.clear();
+  for (const auto& o : order) {
+    cs.push_back(o.second);
+  }
+  return cs;
+}
+
+// pin the calling thread to cpu id.
+static bool pin_to_cpu(const int id) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(id, &set);
+  return ::pthread_setaffinity_np(::pthread_self(), sizeof set, &set) == 0;
+}
+
+// run setup(i) then f(i) on threads pinned to cpu ids[i]; all threads start
+// f at once, after every setup is done.
+template <typename Setup, typename F>
+static void run_pinned(const std::vector<int>& ids, Setup&& setup, F&& f) {
+  std::atomic<size_t> ready{0};
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < ids.size(); ++i) {
+    threads.emplace_back([&, i] {
+      if (!pin_to_cpu(ids[i])) {
+        ::fprintf(stderr, "warning: cannot pin a thread to cpu %d.\n", ids[i]);
+      }
+      setup(i);
+      ready.fetch_add(1);
+      // pause between polls, and give up the CPU now and then: setup may run
+      // in_parallel threads on the very CPUs the early ones wait on.
+      for (size_t spins = 1; ready.load() < ids.size(); ++spins) {
+        cpu_relax();
+        if (spins % 1024 == 0) {
+          std::this_thread::yield();
+        }
+      }
+      f(i);
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+// CPUs for setup, those of the NUMA node the process runs on: memory that
+// setup threads first touch ends up where a single thread would put it.
+static const std::vector<int>& setup_cpus() {
+  static const auto ids = [] {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    ::sched_getaffinity(::getpid(), sizeof set, &set);
+    const auto here = ::sched_getcpu();
+    std::error_code ec;
+    for (const auto& entry :
+         fs::directory_iterator("/sys/devices/system/node", ec)) {
+      const auto name = entry.path().filename().string();
+      if (name.rfind("node", 0) != 0 || !std::isdigit(name[4])) {
+        continue;
+      }
+      const auto node = parse_cpulist(read_line(entry.path() / "cpulist"));
+      if (std::find(node.begin(), node.end(), here) == node.end()) {
+        continue;
+      }
+      cpu_set_t local;
+      CPU_ZERO(&local);
+      for (const auto id : node) {
+        if (id < CPU_SETSIZE && CPU_ISSET(id, &set)) {
+          CPU_SET(id, &local);
+        }
+      }
+      if (CPU_COUNT(&local) > 0) {
+        set = local;
+      }
+      break;
+    }
+    std::vector<int> ids;
+    for (int id = 0; id < CPU_SETSIZE; ++id) {
+      if (CPU_ISSET(id, &set)) {
+        ids.push_back(id);
+      }
+    }
+    return ids;
+  }();
+  return ids;
+}
+
+// run f(part, begin, end) over [0, n) split into a range per setup CPU, each
+// on its own thread.
+template <typename F>
+static void in_parallel(const size_t n, F&& f) {
+  const auto& ids = setup_cpus();
+  run_pinned(ids, [](size_t) {}, [&](const size_t part) {
+    f(part, n * part / ids.size(), n * (part + 1) / ids.size());
+  });
+}
+
+// out[0..n) = value(k) for k = 0..n-1 in a uniformly random order, shuffled
+// in parallel: every thread sends each k of its range to a random bucket of
+// out, then the buckets, small enough to stay in a cache, are shuffled each on
+// its own.  Needs no memory besides out.
+template <typename T, typename Value>
+static void shuffled_fill(T* const out, const size_t n, Value&& value) {
+  static constexpr size_t bucket_size = 64 * KiB;
+  const auto buckets = n / bucket_size + 1;
+  const auto parts = setup_cpus().size();
+  std::vector<uint64_t> seeds(parts);
+  std::random_device rd;
+  for (auto& seed : seeds) {
+    seed = uint64_t{rd()} << 32 | rd();
+  }
+  // counts, then offsets, of the indices of each part in each bucket
+  std::vector<std::vector<size_t>> offsets(parts, std::vector<size_t>(buckets));
+  in_parallel(n, [&](const size_t part, const size_t begin, const size_t end) {
+    ankerl::nanobench::Rng rng{seeds[part]};
+    for (auto k = begin; k < end; ++k) {
+      ++offsets[part][rng.bounded(buckets)];
+    }
+  });
+  std::vector<size_t> bucket_begins(buckets + 1);
+  size_t sum = 0;
+  for (size_t b = 0; b < buckets; ++b) {
+    bucket_begins[b] = sum;
+    for (auto& offset : offsets) {
+      sum += std::exchange(offset[b], sum);
+    }
+  }
+  bucket_begins[buckets] = sum;
+
+  in_parallel(n, [&](const size_t part, const size_t begin, const size_t end) {
+    ankerl::nanobench::Rng rng{seeds[part]};
+    for (auto k = begin; k < end; ++k) {
+      out[offsets[part][rng.bounded(buckets)]++] = value(k);
+    }
+  });
+  in_parallel(buckets, [&](const size_t part, const size_t begin,
+                           const size_t end) {
+    ankerl::nanobench::Rng rng{~seeds[part]};
+    for (auto b = begin; b < end; ++b) {
+      std::shuffle(out + bucket_begins[b], out + bucket_begins[b + 1], rng);
+    }
+  });
+}
+
+// a uniformly random permutation of 0..n-1, shuffled in parallel.
+template <typename Index>
+static std::vector<Index, page_allocator<Index>> random_permutation(
+    const size_t n) {
+  std::vector<Index, page_allocator<Index>> order(n);
+  shuffled_fill(order.data(), n,
+                [](const size_t k) { return static_cast<Index>(k); });
+  return order;
+}
+
+// number of hops from memory[0] until it comes back to memory[0].
+static size_t cycle_length(const chain& memory) {
+  const auto start = &memory[0];
+  auto x = start;
+  size_t length = 0;
+  do {
+    x = reinterpret_cast<void* const*>(*x);
+    ++length;
+  } while (x != start && length < memory.size());
+  return length;
+}
+
+// fill memory with a linked list of pointers over limit bytes, visiting every
+// element in random order before coming back to the first one.
+// A shuffled list, i.e. a random permutation, usually splits into many short
+// cycles and chase_pointers may spin in one that fits in a smaller cache;
+// linking the elements in the order of a random permutation makes one cycle,
+// as long as the order is a permutation, which is checked.
+// Returns the bytes reachable from memory[0], i.e. the working set.
+template <typename Index>
+static size_t link_random_chain(chain& memory) {
+  const auto n = memory.size();
+  const auto order = random_permutation<Index>(n);
+  std::atomic<size_t> repeated{0};
+  std::vector<std::atomic<uint64_t>> seen((n + 63) / 64);
+  in_parallel(n, [&](size_t, const size_t begin, const size_t end) {
+    size_t r = 0;
+    for (auto k = begin; k < end; ++k) {
+      memory[order[k]] = &memory[order[k + 1 < n ? k + 1 : 0]];
+      const auto bit = uint64_t{1} << order[k] % 64;
+      r += (seen[order[k] / 64].fetch_or(bit, std::memory_order_relaxed) &
+            bit) != 0;
+    }
+    repeated.fetch_add(r);
+  });
+  return repeated == 0 ? n : cycle_length(memory);
+}
+
+static size_t create_random_chain(chain& memory, const size_t limit) {
+  if (limit == 0) {
+    return 0;
+  }
+  memory.resize(limit / sizeof(void*));
+  const auto reachable =
+      (memory.size() <= UINT32_MAX ? link_random_chain<uint32_t>(memory)
+                                   : link_random_chain<uint64_t>(memory)) *
+      sizeof(void*);
+  if (reachable != memory.size() * sizeof(void*)) {
+    ::fprintf(stderr, "warning: chain of %s reaches only %s.\n",
+              size_string(memory.size() * sizeof(void*)).c_str(),
+              size_string(reachable).c_str());
+  }
+  return reachable;
+}
+
+// working-set sweep: chase_pointers over log-spaced working sets from 4KiB up
+// to --max-size, --points-per-octave sizes per doubling; and knees of the
+// latency curve.
+static void sweep(const argh::parser& cmdline, std::ostream* outstream) {
+  const auto sizes =
+      log_spaced(4 * KiB, size_param(cmdline, "--max-size", memory_chunk),
+                 points_per_octave_param(cmdline, 4), cache_line_size);
+
+  chain memory{page_allocator<void*>{pages_param(cmdline)}};
+  std::vector<size_t> reachable;
+  ankerl::nanobench::Bench random_access;
+  random_access.title("working-set sweep").output(outstream);
+  for (const auto size : sizes) {
+    reachable.push_back(create_random_chain(memory, size));
+    if (size > L3_cache_size) {
+      // as with memory_random_access, one pass over the chain is plenty.
+      random_access.epochs(1).epochIterations(1);
+    }
+    random_access.run("random_access_" + size_string(size), [&] {
+      ankerl::nanobench::doNotOptimizeAway(chase_pointers(memory));
+    });
+  }
+
+  if (outstream != nullptr) {
+    ::printf("\n");
+  }
+  std::vector<double> ns(sizes.size());
+  std::vector<std::string> xs;
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    xs.push_back(size_string(sizes[i]));
+    const auto& r = random_access.results()[i];
+    const auto elements = sizes[i] / sizeof(void*);
+    ns[i] = latency_per_element(r, elements);
+    print_ns_cyc("random_access_" + xs[i], ns[i],
+                 cpucycles_per_element(r, elements), reachable[i]);
+  }
+
+  print_knees(xs, ns);
+  ::printf("(glibc reports L1: %s; L2: %s; L3: %s.)\n",
+           size_string(L1_cache_size).c_str(),
+           size_string(L2_cache_size).c_str(),
+           size_string(L3_cache_size).c_str());
+}
+
+// random access latency at L1, L2, L3, "memory" sizes on 4KiB pages and on
+// huge pages side by side: the difference is mostly the cost of page walks.
+static void hugepages(const argh::parser&, std::ostream* outstream) {
+  static constexpr pages backings[] = {pages::small, pages::thp,
+                                       pages::huge_2MiB, pages::huge_1GiB};
+  std::vector<size_t> sizes;
+  for (const auto& level : levels()) {
+    sizes.push_back(level.size);
+  }
+
+  // ns[backing][size] for the first measured[backing] sizes; the rest did
+  // not get the pages.
+  std::vector<std::vector<double>> ns(std::size(backings),
+                                      std::vector<double>(sizes.size()));
+  std::vector<size_t> measured(std::size(backings));
+  std::vector<size_t> huge(std::size(backings));
+  for (size_t b = 0; b < std::size(backings); ++b) {
+    ankerl::nanobench::Bench random_access;
+    random_access.title("random access on " + pages_string(backings[b]) +
+                        " pages")
+        .output(outstream);
+    for (size_t i = 0; i < sizes.size(); ++i) {
+      chain memory{page_allocator<void*>{backings[b]}};
+      try {
+        create_random_chain(memory, sizes[i]);
+      } catch (const std::bad_alloc&) {
+        ::fprintf(stderr,
+                  "warning: no %s pages for %s; reserve them in "
+                  "/sys/kernel/mm/hugepages/.\n",
+                  pages_string(backings[b]).c_str(),
+                  size_string(sizes[i]).c_str());
+        break;
+      }
+      if (sizes[i] == memory_chunk) {
+        huge[b] = huge_page_bytes(&memory[0]);
+      }
+      if (sizes[i] > L3_cache_size) {
+        random_access.epochs(1).epochIterations(1);
+      }
+      random_access.run("random_access_" + size_string(sizes[i]), [&] {
+        ankerl::nanobench::doNotOptimizeAway(chase_pointers(memory));
+      });
+      ns[b][i] = latency_per_element(random_access.results().back(),
+                                     sizes[i] / sizeof(void*));
+      ++measured[b];
+    }
+  }
+
+  ::printf("\n%-30s", "random_access");
+  for (const auto backing : backings) {
+    ::printf(" %13s", (pages_string(backing) + " pages").c_str());
+  }
+  ::printf("\n");
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    ::printf("%-30s %10.1f ns", size_string(sizes[i]).c_str(), ns[0][i]);
+    for (size_t b = 1; b < std::size(backings); ++b) {
+      if (i >= measured[b]) {
+        ::printf(" %13s", "-");
+      } else {
+        ::printf(" %+10.1f ns", ns[b][i] - ns[0][i]);
+      }
+    }
+    ::printf("\n");
+  }
+  ::printf("(huge pages are relative to 4KiB pages; of %s, huge pages back",
+           size_string(memory_chunk).c_str());
+  for (size_t b = 1; b < std::size(backings); ++b) {
+    ::printf(" %s with %s%s", size_string(huge[b]).c_str(),
+             pages_string(backings[b]).c_str(),
+             b + 1 < std::size(backings) ? ";" : ".)\n");
+  }
+}
+
+// write a byte to every PAGESIZE page of [p, p + bytes): the first touch of
+// fresh anonymous memory faults the page in, zeroed.
+static void touch_pages(char* p, const size_t bytes) {
+  for (size_t i = 0; i < bytes; i += PAGESIZE) {
+    p[i] = 1;
+  }
+}
+
+// first touch of --fault-size (default: 64MiB) of fresh anonymous memory on
+// 4KiB, transparent huge and hugetlb pages: faulted in by touching each page,
+// populated up front by madvise(MADV_POPULATE_WRITE) (MAP_POPULATE on an
+// existing mapping, which works after madvise(MADV_HUGEPAGE) too), or by
+// mlock(2).  Medians of a few rounds of map, fault in and touch, then unmap.
+static void page_faults(const argh::parser& cmdline, std::ostream*) {
+  static constexpr pages backings[] = {pages::small, pages::thp,
+                                       pages::huge_2MiB, pages::huge_1GiB};
+  static constexpr const char* ways[] = {"touch", "populate", "mlock"};
+  static constexpr size_t rounds = 5;
+  const auto fault_size = size_param(cmdline, "--fault-size", 64 * MiB);
+
+  ::printf("%-30s %12s %12s %10s %12s\n", "first touch", "ns/page",
+           "ns/4KiB", "GB/s", "unmap ns/page");
+  for (const auto backing : backings) {
+    const auto page = page_size(backing);
+    const auto bytes = std::max((fault_size + page - 1) / page * page, page);
+    for (size_t way = 0; way < std::size(ways); ++way) {
+      std::vector<double> fault_ns, unmap_ns;
+      for (size_t round = 0; round < rounds; ++round) {
+        page_allocator<char> allocator{backing};
+        const auto start = std::chrono::steady_clock::now();
+        char* p;
+        try {
+          p = allocator.allocate(bytes);
+        } catch (const std::bad_alloc&) {
+          break;
+        }
+        auto ok = true;
+        if (way == 1) {
+          ok = ::madvise(p, bytes, MADV_POPULATE_WRITE) == 0;
+        } else if (way == 2) {
+          ok = ::mlock(p, bytes) == 0;
+        }
+        if (ok) {
+          touch_pages(p, bytes);
+        }
+        const auto touched = std::chrono::steady_clock::now();
+        allocator.deallocate(p, bytes);
+        const auto unmapped = std::chrono::steady_clock::now();
+        if (!ok) {
+          ::fprintf(stderr, "warning: %s of %s pages failed: %s.\n", ways[way],
+                    pages_string(backing).c_str(), std::strerror(errno));
+          break;
+        }
+        fault_ns.push_back(
+            std::chrono::duration<double, std::nano>(touched - start).count());
+        unmap_ns.push_back(std::chrono::duration<double, std::nano>(
+                               unmapped - touched).count());
+      }
+      if (fault_ns.size() < rounds) {
+        if (way == 0) {
+          ::fprintf(stderr,
+                    "warning: no %s pages for %s; reserve them in "
+                    "/sys/kernel/mm/hugepages/.\n",
+                    pages_string(backing).c_str(), size_string(bytes).c_str());
+          break;
+        }
+        continue;
+      }
+      std::sort(fault_ns.begin(), fault_ns.end());
+      std::sort(unmap_ns.begin(), unmap_ns.end());
+      const auto pages_faulted = static_cast<double>(bytes / page);
+      ::printf("%-30s %12.1f %12.1f %10.2f %12.1f\n",
+               ("fault_" + pages_string(backing) + "_" + ways[way]).c_str(),
+               fault_ns[rounds / 2] / pages_faulted,
+               fault_ns[rounds / 2] / (bytes / (4 * KiB)),
+               bytes / fault_ns[rounds / 2],
+               unmap_ns[rounds / 2] / pages_faulted);
+    }
+  }
+}
+
+// TLB reach and page walk latency: chains of one node per page and one node
+// per --page-stride pages (default: 512 pages, i.e. a page table each), so
+// that every hop lands on a new page.  Nodes sit at a different cache line
+// within each page so that their data stays in L1/L2 (all at offset 0 would
+// fight for a single cache set).  Compared with a compact chain over as many
+// cache lines, the difference is the cost of address translation.
+static void tlb(const argh::parser& cmdline, std::ostream* outstream) {
+  size_t max_pages;
+  cmdline("--max-pages",
+          L2_cache_size != 0 ? L2_cache_size / cache_line_size / 2 : 16384) >>
+      max_pages;
+  size_t page_stride;
+  cmdline("--page-stride", 512) >> page_stride;
+  const auto counts =
+      log_spaced(4, max_pages, points_per_octave_param(cmdline, 2), 1);
+  if (counts.empty()) {
+    return;
+  }
+
+  // nodes of the compact chain are adjacent cache lines.
+  auto measure = [&](const std::string& title, const size_t stride) {
+    const auto step = stride != 0 ? stride * PAGESIZE : cache_line_size;
+    mapping span(counts.back() * step + PAGESIZE);
+    ankerl::nanobench::Bench page_walk;
+    page_walk.title(title).output(outstream);
+    std::vector<void**> nodes;
+    for (const auto count : counts) {
+      nodes.clear();
+      for (size_t k = 0; k < count; ++k) {
+        const auto offset = stride != 0 ? k * cache_line_size % PAGESIZE : 0;
+        nodes.push_back(
+            reinterpret_cast<void**>(span.data + k * step + offset));
+      }
+      link_random_cycle(nodes);
+      page_walk.run(std::to_string(count) + "_pages", [&] {
+        ankerl::nanobench::doNotOptimizeAway(chase_pointers(nodes[0], count));
+      });
+    }
+    return page_walk;
+  };
+
+  const auto compact = measure("compact chain", 0);
+  std::vector<size_t> strides{1};
+  if (page_stride > 1) {
+    strides.push_back(page_stride);
+  }
+  for (const auto stride : strides) {
+    const auto scattered =
+        measure("one node per " + std::to_string(stride) + " pages", stride);
+    if (outstream != nullptr || stride != strides.front()) {
+      ::printf("\n");
+    }
+    std::vector<std::string> xs;
+    std::vector<double> translated;
+    for (size_t i = 0; i < counts.size(); ++i) {
+      const auto& r = scattered.results()[i];
+      const auto& base = compact.results()[i];
+      const auto ns = latency_per_element(r, counts[i]);
+      const auto cycles = cpucycles_per_element(r, counts[i]);
+      const auto walk_ns = ns - latency_per_element(base, counts[i]);
+      const auto walk_cycles = cycles - cpucycles_per_element(base, counts[i]);
+      const auto row = "tlb_" + std::to_string(counts[i]) + "_pages_stride_" +
+                       std::to_string(stride);
+      if (std::isnormal(cycles)) {
+        ::printf("%-30s %10.1f ns %10.1f cycles %+8.1f ns %+8.1f cycles "
+                 "translation\n",
+                 row.c_str(), ns, cycles, walk_ns, walk_cycles);
+      } else {
+        ::printf("%-30s %10.1f ns %+8.1f ns translation\n", row.c_str(), ns,
+                 walk_ns);
+      }
+      xs.push_back(std::to_string(counts[i]) + "_pages");
+      // translation on top of an L1 hit keeps knee ratios meaningful.
+      translated.push_back(latency_per_element(compact.results()[0],
+                                               counts[0]) +
+                           std::max(walk_ns, 0.0));
+    }
+    print_knees(xs, translated);
+  }
+  ::printf("(the first knees are the L1 dTLB and STLB reach in %s pages.)\n",
+           size_string(PAGESIZE).c_str());
+}
+
+// memory-level parallelism: K chains in lockstep over one chain of each
+// level's size, split into K equal segments, up to --max-chains (default: 32).
+// K independent misses overlap as far as line fill buffers etc. allow; by
+// Little's law, misses outstanding = latency of one chain / ns per access.
+static void mlp(const argh::parser& cmdline, std::ostream* outstream) {
+  static constexpr size_t samples = 1024;
+  size_t most_chains;
+  cmdline("--max-chains", max_chains) >> most_chains;
+  const auto chain_counts =
+      log_spaced(1, std::clamp(most_chains, size_t{1}, max_chains), 4, 1);
+
+  chain memory{page_allocator<void*>{pages_param(cmdline)}};
+  std::vector<std::string> rows;
+  std::vector<double> ns;
+  std::vector<size_t> row_chains;
+  for (const auto& level : levels()) {
+    create_random_chain(memory, level.size);
+    const auto nodes = sample_chain(memory, samples);
+    ankerl::nanobench::Bench parallel_access;
+    parallel_access.title(level.name + " chains in lockstep").output(outstream);
+    if (level.size > L3_cache_size) {
+      parallel_access.epochs(1).epochIterations(1);
+    }
+    for (const auto k : chain_counts) {
+      std::vector<void* const*> starts;
+      for (size_t j = 0; j < k; ++j) {
+        starts.push_back(nodes[j * samples / k]);
+      }
+      const auto count = memory.size() / k;
+      const auto name =
+          "mlp_" + level.name + "_" + std::to_string(k) + "_chains";
+      parallel_access.run(name, [&] {
+        ankerl::nanobench::doNotOptimizeAway(
+            chase_chains_by_count[k - 1](starts.data(), count));
+      });
+      rows.push_back(name);
+      ns.push_back(latency_per_element(parallel_access.results().back(),
+                                       count * k));
+      row_chains.push_back(k);
+    }
+  }
+
+  if (outstream != nullptr) {
+    ::printf("\n");
+  }
+  double single = 0;
+  for (size_t i = 0; i < rows.size(); ++i) {
+    if (row_chains[i] == 1) {
+      single = ns[i];
+    }
+    ::printf("%-30s %10.2f ns/access %6.1f outstanding\n", rows[i].c_str(),
+             ns[i], single / ns[i]);
+  }
+}
+
+// chase from x, prefetching the node distance hops ahead, known from the
+// lookahead array of the nodes in the order of the chase.  The position in
+// the array depends on the node reached (by adding x & 0, a zero the compiler
+// cannot see), or out-of-order execution would run ahead with the prefetches
+// whatever the distance.
+static void* chase_pointers_prefetching(void* const* x,
+                                        void* const* const* ahead,
+                                        const size_t distance, size_t count) {
+  uintptr_t zero = 0;
+  asm("" : "+r"(zero));
+  for (auto p = ahead + distance; count--;) {
+    __builtin_prefetch(*p);
+    x = reinterpret_cast<void* const*>(*x);
+    p += 1 + (reinterpret_cast<uintptr_t>(x) & zero);
+  }
+  return *x;
+}
+
+// software prefetch distance: a chain of "memory" size, chased --hops
+// (default: 4M) hops from its start with a prefetch of the node 1 to
+// --max-distance (default: 32) hops ahead, vs the plain chase.  The nodes
+// still come from the chain; the lookahead array stands in for whatever lets
+// a B-tree or hash probe know addresses before it needs them.
+static void prefetch_distance(const argh::parser& cmdline,
+                              std::ostream* outstream) {
+  size_t max_distance;
+  cmdline("--max-distance", 32) >> max_distance;
+  chain memory{page_allocator<void*>{pages_param(cmdline)}};
+  create_random_chain(memory, memory_chunk);
+  size_t hops;
+  cmdline("--hops", 4 * MiB) >> hops;
+  hops = std::clamp(hops, size_t{1}, memory.size());
+
+  std::vector<void* const*> ahead(hops + max_distance);
+  void* const* x = &memory[0];
+  for (auto& node : ahead) {
+    node = x;
+    x = reinterpret_cast<void* const*>(*x);
+  }
+
+  ankerl::nanobench::Bench prefetching;
+  prefetching.title("memory chain with software prefetch").output(outstream)
+      .epochs(1).epochIterations(1);
+  prefetching.run("prefetch_none", [&] {
+    ankerl::nanobench::doNotOptimizeAway(chase_pointers(&memory[0], hops));
+  });
+  const auto plain = latency_per_element(prefetching.results().back(), hops);
+  std::vector<double> ns;
+  for (size_t distance = 1; distance <= max_distance; ++distance) {
+    prefetching.run("prefetch_" + std::to_string(distance) + "_ahead", [&] {
+      ankerl::nanobench::doNotOptimizeAway(chase_pointers_prefetching(
+          &memory[0], ahead.data(), distance, hops));
+    });
+    ns.push_back(latency_per_element(prefetching.results().back(), hops));
+  }
+
+  if (outstream != nullptr) {
+    ::printf("\n");
+  }
+  ::printf("%-30s %10.1f ns\n", "prefetch_none", plain);
+  size_t best = 0;
+  for (size_t i = 0; i < ns.size(); ++i) {
+    ::printf("%-30s %10.1f ns %6.2fx\n",
+             ("prefetch_" + std::to_string(i + 1) + "_ahead").c_str(), ns[i],
+             plain / ns[i]);
+    if (ns[i] < ns[best]) {
+      best = i;
+    }
+  }
+  // the shortest distance within 5% of the best: prefetching further ahead
+  // only holds more lines in the caches.
+  size_t enough = 0;
+  while (enough < best && ns[enough] > ns[best] * 1.05) {
+    ++enough;
+  }
+  if (!ns.empty()) {
+    ::printf("(best distance: %zu hops, %.2fx the plain chase; %zu hops "
+             "within 5%%.)\n",
+             best + 1, plain / ns[best], enough + 1);
+  }
+}
+
+// DRAM row-buffer locality: a chain of one node per cache line over "memory"
+// that visits the lines of a window in random order, then those of another
+// window, windows in random order.  Within a window of a DRAM page or so
+// (4KiB, 8KiB) misses may hit an open row; 2MiB is a huge page, so no TLB
+// misses either; a window of the whole chunk is fully random.  Physically
+// contiguous windows need huge pages: transparent ones unless --pages.
+static void row_locality(const argh::parser& cmdline,
+                         std::ostream* outstream) {
+  static constexpr size_t windows[] = {4 * KiB, 8 * KiB, 2 * MiB};
+  const auto backing = cmdline("--pages") ? pages_param(cmdline) : pages::thp;
+  mapping span(memory_chunk, backing);
+  const auto lines = span.size / cache_line_size;
+  auto node = [&](const size_t line) {
+    return reinterpret_cast<void**>(span.data + line * cache_line_size);
+  };
+
+  std::vector<size_t> sizes(std::begin(windows), std::end(windows));
+  sizes.push_back(span.size);
+  ankerl::nanobench::Bench windowed_access;
+  windowed_access.title("chase within windows of memory").output(outstream)
+      .epochs(1).epochIterations(1);
+  std::vector<double> ns;
+  for (const auto window : sizes) {
+    const auto per_window = window / cache_line_size;
+    if (per_window >= lines) {
+      // one window: all lines in random order.
+      const auto order = random_permutation<uint32_t>(lines);
+      in_parallel(lines, [&](size_t, const size_t begin, const size_t end) {
+        for (auto k = begin; k < end; ++k) {
+          *node(order[k]) = node(order[k + 1 < lines ? k + 1 : 0]);
+        }
+      });
+    } else {
+      // a window is entered at its first line, and left from its last
+      // visited line for the first line of the next window in order.
+      const auto order = random_permutation<uint32_t>(lines / per_window);
+      in_parallel(order.size(), [&](const size_t part, const size_t begin,
+                                    const size_t end) {
+        if (begin == end) {
+          return;
+        }
+        ankerl::nanobench::Rng rng{uint64_t{std::random_device{}()} << 32 |
+                                   part};
+        std::vector<size_t> within(per_window);
+        for (auto w = begin; w < end; ++w) {
+          std::iota(within.begin(), within.end(), order[w] * per_window);
+          std::shuffle(within.begin() + 1, within.end(), rng);
+          for (size_t j = 0; j + 1 < per_window; ++j) {
+            *node(within[j]) = node(within[j + 1]);
+          }
+          *node(within.back()) =
+              node(order[w + 1 < order.size() ? w + 1 : 0] * per_window);
+        }
+      });
+    }
+    windowed_access.run("row_locality_" + size_string(window), [&] {
+      ankerl::nanobench::doNotOptimizeAway(chase_pointers(node(0), lines));
+    });
+    ns.push_back(latency_per_element(windowed_access.results().back(), lines));
+  }
+
+  if (outstream != nullptr) {
+    ::printf("\n");
+  }
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    ::printf("%-30s %10.1f ns %+8.1f ns (%+.0f%%) vs fully random\n",
+             ("row_locality_" + size_string(sizes[i])).c_str(), ns[i],
+             ns[i] - ns.back(), (ns[i] / ns.back() - 1) * 100);
+  }
+  ::printf("(%s pages.)\n", pages_used_string(span.data).c_str());
+}
+
+// stride sweep: at each level, chains over a span of the level's size with
+// nodes stride bytes apart, chased in address order and in random order.
+// In address order hardware prefetchers can fetch lines ahead of the chase,
+// the random order defeats them: the saving shows how far they reach.
+// 4096+64 and 8192+64 cross a page on every hop without hitting one cache
+// set; streaming prefetchers do not cross pages.
+// Two findings per level: the adjacent-line prefetcher fetches a line's
+// buddy of its 128B pair, used by a random chase at one line's stride, not
+// at two lines'; streaming prefetchers save in address order from two lines'
+// stride on until the stride they give up at.
+static void stride(const argh::parser& cmdline, std::ostream* outstream) {
+  static constexpr double helps_ratio = 0.8;
+  static constexpr size_t strides[] = {8,    16,   32,   64,        128,
+                                       256,  512,  1024, 2048,      4096,
+                                       4160, 8256};
+  const auto backing = pages_param(cmdline);
+  bool first = true;
+  for (const auto& level : levels()) {
+    mapping span(level.size, backing);
+    ankerl::nanobench::Bench strided_access;
+    strided_access.title(level.name + " strided access").output(outstream);
+    if (level.size > L3_cache_size) {
+      strided_access.epochs(1).epochIterations(1);
+    }
+    // ns[stride][0: address order, 1: random order]
+    std::vector<std::array<double, 2>> ns;
+    for (const auto stride : strides) {
+      const auto n = level.size / stride;
+      if (n < 2) {
+        break;
+      }
+      auto node = [&](const size_t k) {
+        return reinterpret_cast<void**>(span.data + k * stride);
+      };
+      in_parallel(n, [&](size_t, const size_t begin, const size_t end) {
+        for (auto k = begin; k < end; ++k) {
+          *node(k) = node((k + 1) % n);
+        }
+      });
+      ns.emplace_back();
+      const char* orders[] = {"address_order", "random_order"};
+      for (size_t o = 0; o < std::size(orders); ++o) {
+        auto start = node(0);
+        if (o == 1) {
+          const auto order = random_permutation<uint32_t>(n);
+          in_parallel(n, [&](size_t, const size_t begin, const size_t end) {
+            for (auto k = begin; k < end; ++k) {
+              *node(order[k]) = node(order[(k + 1) % n]);
+            }
+          });
+          start = node(order[0]);
+        }
+        strided_access.run(
+            level.name + "_" + std::to_string(stride) + "B_" + orders[o], [&] {
+              ankerl::nanobench::doNotOptimizeAway(chase_pointers(start, n));
+            });
+        ns.back()[o] = latency_per_element(strided_access.results().back(), n);
+      }
+    }
+
+    if (outstream != nullptr || !first) {
+      ::printf("\n");
+    }
+    first = false;
+    size_t line = ns.size(), pair = ns.size();
+    for (size_t i = 0; i < ns.size(); ++i) {
+      const auto saving = 1 - ns[i][0] / ns[i][1];
+      ::printf("%-30s %10.1f ns %10.1f ns random %5.0f%% saved\n",
+               ("stride_" + level.name + "_" + std::to_string(strides[i]) + "B")
+                   .c_str(),
+               ns[i][0], ns[i][1], saving * 100);
+      if (strides[i] == cache_line_size) {
+        line = i;
+      } else if (strides[i] == 2 * cache_line_size) {
+        pair = i;
+      }
+    }
+    if (line < ns.size() && pair < ns.size()) {
+      ::printf("(%s: adjacent-line prefetch: random order at %zuB costs "
+               "%+.0f%% vs %zuB%s.)\n",
+               level.name.c_str(), strides[pair],
+               (ns[pair][1] / ns[line][1] - 1) * 100, strides[line],
+               ns[line][1] <= ns[pair][1] * helps_ratio ? ", pairs lines"
+                                                         : ", no pairs");
+      // beyond line pairs; at L1 there is nothing to prefetch, only flag once
+      // streaming prefetchers helped.
+      bool helped = false;
+      size_t stops = 0;
+      for (auto i = pair; i < ns.size() && stops == 0; ++i) {
+        if (ns[i][0] <= ns[i][1] * helps_ratio) {
+          helped = true;
+        } else if (helped) {
+          stops = strides[i];
+        }
+      }
+      if (stops != 0) {
+        ::printf("(%s: streaming prefetchers save less than %.0f%% from "
+                 "stride %zuB.)\n",
+                 level.name.c_str(), (1 - helps_ratio) * 100, stops);
+      } else if (!helped) {
+        ::printf("(%s: streaming prefetchers save less than %.0f%% from "
+                 "stride %zuB on.)\n",
+                 level.name.c_str(), (1 - helps_ratio) * 100, strides[pair]);
+      }
+    }
+  }
+}
+
+// cache associativity: chains of 1 to --max-ways (default: 32) nodes spaced a
+// power of two apart, 4KiB to 1MiB.  Nodes that far apart share one cache set
+// of every level whose sets span no more than the spacing, so a few lines miss
+// a cache many times their size: the knee in node count is the number of ways.
+// Set indices beyond bit 11 are physical, hence transparent huge pages unless
+// --pages says otherwise; L3 slice hashing usually hides L3 conflicts.
+//
+// A level of size S and W ways holds max(W, S / spacing) such nodes, so its
+// knee comes at S / spacing nodes until the spacing reaches S / W, and at W
+// nodes from there on.  A level's inferred ways are the W whose knees match
+// the spacings best, exact knees before those within one node, at least one
+// of them exactly at W nodes; ties go to the W with the most knees exactly at
+// W.  W starts at 4, and at S / 4KiB for a virtually indexed L1, so small
+// knees well below any plausible ways are ignored.  The result is
+// inconclusive unless W has exact knees at W nodes at two spacings or more,
+// more exact knees than any other W, and sysconf's ways, where they differ,
+// fail to explain two knees of their own.  Levels go in size order, each
+// ignoring knees matched by a conclusive level before.
+static void associativity(const argh::parser& cmdline,
+                          std::ostream* outstream) {
+  static constexpr size_t min_spacing = 4 * KiB;
+  static constexpr size_t max_spacing = MiB;
+  // fewer ways than this are implausible; smaller knees are TLB or LRU noise.
+  static constexpr size_t fewest_ways = 4;
+  size_t max_ways;
+  cmdline("--max-ways", 32) >> max_ways;
+  max_ways = std::max(max_ways, fewest_ways);
+  const auto backing = cmdline("--pages") ? pages_param(cmdline) : pages::thp;
+
+  auto caches = levels();
+  caches.erase(
+      std::remove_if(caches.begin(), caches.end(),
+                     [](const level& l) { return l.name == "memory"; }),
+      caches.end());
+  // per spacing, the node counts that may still fit before each knee: a rise
+  // over several steps leaves the counts in between in doubt.
+  std::vector<size_t> spacings;
+  std::vector<std::vector<std::pair<size_t, size_t>>> knees;
+
+  mapping span(max_ways * max_spacing, backing);
+  for (auto spacing = min_spacing; spacing <= max_spacing; spacing *= 2) {
+    ankerl::nanobench::Bench conflicts;
+    conflicts.title("nodes " + size_string(spacing) + " apart")
+        .output(outstream);
+    std::vector<std::string> xs;
+    std::vector<double> ns;
+    std::vector<void**> nodes;
+    for (size_t count = 1; count <= max_ways; ++count) {
+      nodes.clear();
+      for (size_t k = 0; k < count; ++k) {
+        nodes.push_back(reinterpret_cast<void**>(span.data + k * spacing));
+      }
+      link_random_cycle(nodes);
+      // laps of the short chain, or runs would overlap out of order.
+      const auto hops = count * (1 + 1024 / count);
+      xs.push_back(size_string(spacing) + "_" + std::to_string(count) +
+                   "_nodes");
+      conflicts.run(xs.back(), [&] {
+        ankerl::nanobench::doNotOptimizeAway(chase_pointers(nodes[0], hops));
+      });
+      ns.push_back(latency_per_element(conflicts.results().back(), hops));
+    }
+    if (outstream != nullptr || spacing != min_spacing) {
+      ::printf("\n");
+    }
+    ::printf("%-30s %10.1f ns (1 node) %10.1f ns (%zu nodes)\n",
+             ("conflicts_" + size_string(spacing)).c_str(), ns.front(),
+             ns.back(), max_ways);
+    print_knees(xs, ns);
+    spacings.push_back(spacing);
+    knees.emplace_back();
+    for (const auto& knee : find_knees(ns)) {
+      knees.back().emplace_back(knee.first + 1, knee.second);
+    }
+  }
+
+  auto knee_at = [&](const size_t s, const size_t k, const size_t nodes) {
+    return knees[s][k].first <= nodes && nodes <= knees[s][k].second;
+  };
+  // index into knees[s] of the knee at nodes, else of one within one, or -1.
+  auto knee_near = [&](const size_t s, const size_t nodes) {
+    auto best = -1;
+    for (size_t k = 0; k < knees[s].size(); ++k) {
+      if (knee_at(s, k, nodes)) {
+        return static_cast<int>(k);
+      }
+      if (knees[s][k].first <= nodes + 1 && nodes <= knees[s][k].second + 1) {
+        best = k;
+      }
+    }
+    return best;
+  };
+  // how well W ways of a level of size bytes explain the knees.
+  struct fit_of_ways {
+    size_t exact = 0;  // knees exactly at the predicted node count
+    size_t near = 0;   // knees within one of it
+    size_t at_w = 0;   // exact knees at W nodes, where W decides
+  };
+  auto score = [&](const size_t size, const size_t w) {
+    fit_of_ways f;
+    for (size_t s = 0; s < spacings.size(); ++s) {
+      const auto fit = (size + spacings[s] - 1) / spacings[s];
+      const auto nodes = std::max(w, fit);
+      const auto k = knee_near(s, nodes);
+      if (k < 0) {
+        continue;
+      }
+      if (knee_at(s, k, nodes)) {
+        ++f.exact;
+        f.at_w += fit <= w;
+      } else {
+        ++f.near;
+      }
+    }
+    return f;
+  };
+  // exact knees outweigh all knees within one node together, then ties go to
+  // the most exact knees at W.
+  auto better = [](const fit_of_ways& x, const fit_of_ways& y) {
+    return std::tie(x.exact, x.near, x.at_w) > std::tie(y.exact, y.near, y.at_w);
+  };
+  ::printf("\n");
+  for (const auto& cache : caches) {
+    // a virtually indexed L1 spans no more than a 4KiB page per way.
+    const auto fewest =
+        std::max(fewest_ways,
+                 cache.name == "L1" ? cache.size / min_spacing : size_t{0});
+    size_t ways = 0;
+    fit_of_ways best, runner_up;
+    for (size_t w = fewest; w <= max_ways; ++w) {
+      const auto f = score(cache.size, w);
+      if (f.at_w == 0) {
+        continue;
+      }
+      if (ways == 0 || better(f, best)) {
+        runner_up = ways == 0 ? runner_up : best;
+        ways = w;
+        best = f;
+      } else if (better(f, runner_up)) {
+        runner_up = f;
+      }
+    }
+    const auto reported =
+        sysconf(cache.name == "L1"   ? _SC_LEVEL1_DCACHE_ASSOC
+                : cache.name == "L2" ? _SC_LEVEL2_CACHE_ASSOC
+                                     : _SC_LEVEL3_CACHE_ASSOC);
+    // conclusive: exact knees at W nodes at two spacings or more, more exact
+    // knees than any other W, and sysconf's ways, if they differ, explaining
+    // no two knees at their own node count.
+    const auto sysconf_fit =
+        reported > 0 && static_cast<size_t>(reported) != ways
+            ? score(cache.size, reported)
+            : fit_of_ways{};
+    const auto conclusive = ways != 0 && best.at_w >= 2 &&
+                            best.exact > runner_up.exact &&
+                            sysconf_fit.at_w < 2;
+    if (conclusive) {
+      for (size_t s = 0; s < spacings.size(); ++s) {
+        const auto fit = (cache.size + spacings[s] - 1) / spacings[s];
+        const auto k = knee_near(s, std::max(ways, fit));
+        if (k >= 0) {
+          knees[s].erase(knees[s].begin() + k);
+        }
+      }
+    }
+    const auto name = "associativity_" + cache.name;
+    const auto matches = best.exact + best.near;
+    if (ways == 0) {
+      ::printf("%-30s %10s ways (sysconf: %ld)\n", name.c_str(), "-",
+               reported);
+    } else if (!conclusive) {
+      ::printf("%-30s %10s (sysconf: %ld; best guess %zu ways, knees at %zu "
+               "of %zu spacings)\n",
+               name.c_str(), "inconclusive", reported, ways, matches,
+               spacings.size());
+    } else if (reported > 0 && static_cast<size_t>(reported) != ways) {
+      ::printf("%-30s %10zu ways but sysconf: %ld (knees at %zu of %zu "
+               "spacings)\n",
+               name.c_str(), ways, reported, matches, spacings.size());
+    } else {
+      ::printf("%-30s %10zu ways (sysconf: %ld; knees at %zu of %zu "
+               "spacings)\n",
+               name.c_str(), ways, reported, matches, spacings.size());
+    }
+  }
+  ::printf("(%s pages; -: no knee of a set conflict up to --max-ways=%zu "
+           "nodes %s apart.)\n",
+           pages_used_string(span.data).c_str(), max_ways,
+           size_string(max_spacing).c_str());
+}
+
+// write path: a random chain of one node per cache line over the first half
+// of each level's size.  Each node also points to a line in the second half.
+struct write_node {
+  write_node* next;
+  uintptr_t* other;
+  uintptr_t count;
+};
+
+static const write_node* chase_and_read(const write_node* x, size_t count) {
+  while (count--) {
+    x = x->next;
+  }
+  return x;
+}
+
+// read-modify-write of every node: lines turn dirty and must be written back
+// when evicted.
+static const write_node* chase_and_modify(write_node* x, size_t count) {
+  while (count--) {
+    ++x->count;
+    x = x->next;
+  }
+  return x;
+}
+
+// store to the other line of every node, dirtying a second line per hop.  The
+// span fits the level, so past the first lap both lines stay resident; only
+// from memory does each store need its line exclusive first (read for
+// ownership).
+static const write_node* chase_and_store(const write_node* x, size_t count) {
+  while (count--) {
+    *x->other = count;
+    x = x->next;
+  }
+  return x;
+}
+
+// the extra cost of writes over the read-only chase at each level.  Stores do
+// not hold up the chain of loads until the store buffer fills; beyond that
+// they are paced by read-for-ownership misses and writebacks.
+static void write_chase(const argh::parser& cmdline, std::ostream* outstream) {
+  const auto backing = pages_param(cmdline);
+  std::vector<std::string> rows;
+  // ns[row][0: read, 1: modify, 2: store to other line]
+  std::vector<std::array<double, 3>> ns;
+  for (const auto& level : levels()) {
+    const auto n = level.size / 2 / cache_line_size;
+    if (n < 2) {
+      continue;
+    }
+    mapping span(level.size, backing);
+    std::vector<void**> nodes(n);
+    for (size_t k = 0; k < n; ++k) {
+      nodes[k] = reinterpret_cast<void**>(span.data + k * cache_line_size);
+    }
+    link_random_cycle(nodes);
+    std::vector<size_t> others(n);
+    std::iota(others.begin(), others.end(), n);
+    std::shuffle(others.begin(), others.end(),
+                 ankerl::nanobench::Rng{std::random_device{}()});
+    for (size_t k = 0; k < n; ++k) {
+      const auto x = reinterpret_cast<write_node*>(nodes[k]);
+      x->other = reinterpret_cast<uintptr_t*>(span.data +
+                                              others[k] * cache_line_size);
+      x->count = 0;
+    }
+    auto start = reinterpret_cast<write_node*>(nodes[0]);
+
+    ankerl::nanobench::Bench write_access;
+    write_access.title(level.name + " write chase").output(outstream);
+    if (level.size > L3_cache_size) {
+      write_access.epochs(1).epochIterations(1);
+    }
+    rows.push_back("write_" + level.name);
+    write_access.run(rows.back() + "_read", [&] {
+      ankerl::nanobench::doNotOptimizeAway(chase_and_read(start, n));
+    });
+    write_access.run(rows.back() + "_modify", [&] {
+      ankerl::nanobench::doNotOptimizeAway(chase_and_modify(start, n));
+    });
+    write_access.run(rows.back() + "_store_other", [&] {
+      ankerl::nanobench::doNotOptimizeAway(chase_and_store(start, n));
+    });
+    ns.emplace_back();
+    for (size_t i = 0; i < 3; ++i) {
+      ns.back()[i] = latency_per_element(write_access.results()[i], n);
+    }
+  }
+
+  if (outstream != nullptr) {
+    ::printf("\n");
+  }
+  ::printf("%-30s %10s %18s %18s\n", "ns per hop", "read", "modify",
+           "store other line");
+  for (size_t i = 0; i < rows.size(); ++i) {
+    ::printf("%-30s %10.1f %9.1f (%+6.1f) %9.1f (%+6.1f)\n", rows[i].c_str(),
+             ns[i][0], ns[i][1], ns[i][1] - ns[i][0], ns[i][2],
+             ns[i][2] - ns[i][0]);
+  }
+}
+
+// STREAM-like bandwidth kernels (https://www.cs.virginia.edu/stream/) over
+// arrays a, b, c of doubles, written once per kind of vector ops.
+// Kernels must not be auto-vectorized or turned into memcpy(3), else the
+// scalar ones would not be scalar and the copy would time libc.  Clang's
+// loop pragma stops only the vectorizer; no_builtin keeps loop idiom
+// recognition from calling memcpy(3) or memset(3).
+#if defined(__clang__)
+#define KERNEL __attribute__((no_builtin("memcpy", "memset", "memmove")))
+#define KERNEL_LOOP _Pragma("clang loop vectorize(disable) interleave(disable)")
+#else
+#define KERNEL \
+  __attribute__((optimize("no-tree-vectorize", "no-tree-loop-distribute-patterns")))
+#define KERNEL_LOOP
+#endif
+
+struct scalar_ops {
+  using type = double;
+  static constexpr size_t width = 1;
+  static type load(const double* p) { return *p; }
+  static void store(double* p, const type x) { *p = x; }
+  static void stream(double* p, const type x) { *p = x; }
+  static type set1(const double x) { return x; }
+  static type add(const type x, const type y) { return x + y; }
+  static type mul(const type x, const type y) { return x * y; }
+  static double sum(const type x) { return x; }
+};
+
+#ifdef __SSE2__
+struct sse_ops {
+  using type = __m128d;
+  static constexpr size_t width = 2;
+  static type load(const double* p) { return _mm_load_pd(p); }
+  static void store(double* p, const type x) { _mm_store_pd(p, x); }
+  static void stream(double* p, const type x) { _mm_stream_pd(p, x); }
+  static type set1(const double x) { return _mm_set1_pd(x); }
+  static type add(const type x, const type y) { return _mm_add_pd(x, y); }
+  static type mul(const type x, const type y) { return _mm_mul_pd(x, y); }
+  static double sum(const type x) { return x[0] + x[1]; }
+};
+#endif
+
+#ifdef __AVX2__
+struct avx2_ops {
+  using type = __m256d;
+  static constexpr size_t width = 4;
+  static type load(const double* p) { return _mm256_load_pd(p); }
+  static void store(double* p, const type x) { _mm256_store_pd(p, x); }
+  static void stream(double* p, const type x) { _mm256_stream_pd(p, x); }
+  static type set1(const double x) { return _mm256_set1_pd(x); }
+  static type add(const type x, const type y) { return _mm256_add_pd(x, y); }
+  static type mul(const type x, const type y) { return _mm256_mul_pd(x, y); }
+  static double sum(const type x) { return x[0] + x[1] + x[2] + x[3]; }
+};
+#endif
+
+#ifdef __AVX512F__
+struct avx512_ops {
+  using type = __m512d;
+  static constexpr size_t width = 8;
+  static type load(const double* p) { return _mm512_load_pd(p); }
+  static void store(double* p, const type x) { _mm512_store_pd(p, x); }
+  static void stream(double* p, const type x) { _mm512_stream_pd(p, x); }
+  static type set1(const double x) { return _mm512_set1_pd(x); }
+  static type add(const type x, const type y) { return _mm512_add_pd(x, y); }
+  static type mul(const type x, const type y) { return _mm512_mul_pd(x, y); }
+  static double sum(const type x) {
+    return x[0] + x[1] + x[2] + x[3] + x[4] + x[5] + x[6] + x[7];
+  }
+};
+#endif
+
+// the widest vector ops, for kernels that come in one variant.
+#if defined(__AVX512F__)
+using widest_ops = avx512_ops;
+#elif defined(__AVX2__)
+using widest_ops = avx2_ops;
+#elif defined(__SSE2__)
+using widest_ops = sse_ops;
+#else
+using widest_ops = scalar_ops;
+#endif
+
+// n must be a multiple of bandwidth_granularity.
+static constexpr size_t bandwidth_granularity = 32;
+static constexpr double stream_scalar = 3.0;
+
+// sum of a; four accumulators hide the latency of additions.
+template <typename V>
+KERNEL static double read_kernel(double* a, double*, double*, const size_t n) {
+  auto s0 = V::set1(0), s1 = V::set1(0), s2 = V::set1(0), s3 = V::set1(0);
+  KERNEL_LOOP
+  for (size_t i = 0; i < n; i += 4 * V::width) {
+    s0 = V::add(s0, V::load(a + i));
+    s1 = V::add(s1, V::load(a + i + V::width));
+    s2 = V::add(s2, V::load(a + i + 2 * V::width));
+    s3 = V::add(s3, V::load(a + i + 3 * V::width));
+  }
+  return V::sum(V::add(V::add(s0, s1), V::add(s2, s3)));
+}
+
+// a = s
+template <typename V>
+KERNEL static double write_kernel(double* a, double*, double*, const size_t n) {
+  const auto s = V::set1(stream_scalar);
+  KERNEL_LOOP
+  for (size_t i = 0; i < n; i += V::width) {
+    V::store(a + i, s);
+  }
+  return a[0];
+}
+
+// c = a
+template <typename V>
+KERNEL static double copy_kernel(double* a, double*, double* c, const size_t n) {
+  KERNEL_LOOP
+  for (size_t i = 0; i < n; i += V::width) {
+    V::store(c + i, V::load(a + i));
+  }
+  return c[0];
+}
+
+// b = s * c
+template <typename V>
+KERNEL static double scale_kernel(double*, double* b, double* c,
+                                  const size_t n) {
+  const auto s = V::set1(stream_scalar);
+  KERNEL_LOOP
+  for (size_t i = 0; i < n; i += V::width) {
+    V::store(b + i, V::mul(s, V::load(c + i)));
+  }
+  return b[0];
+}
+
+// a = b + s * c
+template <typename V>
+KERNEL static double triad_kernel(double* a, double* b, double* c,
+                                  const size_t n) {
+  const auto s = V::set1(stream_scalar);
+  KERNEL_LOOP
+  for (size_t i = 0; i < n; i += V::width) {
+    V::store(a + i, V::add(V::load(b + i), V::mul(s, V::load(c + i))));
+  }
+  return a[0];
+}
+
+using bandwidth_fn = double (*)(double* a, double* b, double* c, size_t n);
+
+struct bandwidth_kernel {
+  const char* name;
+  // bytes explicitly read and written per element, as STREAM counts them.
+  size_t bytes;
+};
+static constexpr bandwidth_kernel bandwidth_kernels[] = {
+    {"read", 8}, {"write", 8}, {"copy", 16}, {"scale", 16}, {"triad", 24}};
+
+struct bandwidth_variant {
+  const char* name;
+  std::array<bandwidth_fn, std::size(bandwidth_kernels)> kernels;
+};
+
+template <typename V>
+static constexpr bandwidth_variant make_bandwidth_variant(const char* name) {
+  return {name,
+          {read_kernel<V>, write_kernel<V>, copy_kernel<V>, scale_kernel<V>,
+           triad_kernel<V>}};
+}
+
+// variants the compiler can emit for this machine (-march=native).
+static const bandwidth_variant bandwidth_variants[] = {
+    make_bandwidth_variant<scalar_ops>("scalar"),
+#ifdef __SSE2__
+    make_bandwidth_variant<sse_ops>("sse"),
+#endif
+#ifdef __AVX2__
+    make_bandwidth_variant<avx2_ops>("avx2"),
+#endif
+#ifdef __AVX512F__
+    make_bandwidth_variant<avx512_ops>("avx512"),
+#endif
+};
+
+// arrays a, b, c of n doubles each, n a multiple of bandwidth_granularity.
+struct stream_arrays {
+  size_t n;
+  mapping memory;
+  double* a;
+  double* b;
+  double* c;
+
+  stream_arrays(const size_t bytes, const pages backing)
+      : n(std::max(bytes / 3 / sizeof(double) / bandwidth_granularity,
+                   size_t{1}) *
+          bandwidth_granularity),
+        memory(3 * n * sizeof(double), backing),
+        a(reinterpret_cast<double*>(memory.data)),
+        b(a + n),
+        c(b + n) {
+    std::fill(a, c + n, 1.0);
+  }
+};
+
+// STREAM-like bandwidth of each kernel and variant over arrays of half of
+// each cache level (so that they stay in it) and of "memory".
+static void bandwidth(const argh::parser& cmdline, std::ostream* outstream) {
+  std::vector<std::string> rows;
+  // gbs[row][variant], bytes_per_cycle[row][variant]
+  std::vector<std::vector<double>> gbs, bytes_per_cycle;
+  for (const auto& level : levels()) {
+    stream_arrays arrays(level.size == memory_chunk ? level.size : level.size / 2,
+                         pages_param(cmdline));
+    ankerl::nanobench::Bench stream;
+    stream.title(level.name + " bandwidth").unit("byte").output(outstream);
+    for (size_t k = 0; k < std::size(bandwidth_kernels); ++k) {
+      const auto bytes = arrays.n * bandwidth_kernels[k].bytes;
+      rows.push_back(level.name + "_" + bandwidth_kernels[k].name);
+      gbs.emplace_back();
+      bytes_per_cycle.emplace_back();
+      for (const auto& variant : bandwidth_variants) {
+        stream.batch(bytes).run(rows.back() + "_" + variant.name, [&] {
+          ankerl::nanobench::doNotOptimizeAway(
+              variant.kernels[k](arrays.a, arrays.b, arrays.c, arrays.n));
+        });
+        const auto& r = stream.results().back();
+        gbs.back().push_back(1 / latency_per_element(r, bytes));
+        bytes_per_cycle.back().push_back(1 / cpucycles_per_element(r, bytes));
+      }
+    }
+  }
+
+  auto print_table = [&](const char* unit,
+                         const std::vector<std::vector<double>>& table) {
+    ::printf("\n%-30s", unit);
+    for (const auto& variant : bandwidth_variants) {
+      ::printf(" %9s", variant.name);
+    }
+    ::printf("\n");
+    for (size_t i = 0; i < rows.size(); ++i) {
+      ::printf("%-30s", ("bandwidth_" + rows[i]).c_str());
+      for (const auto x : table[i]) {
+        ::printf(" %9.1f", x);
+      }
+      ::printf("\n");
+    }
+  };
+  print_table("GB/s", gbs);
+  if (std::isnormal(bytes_per_cycle[0][0])) {
+    print_table("bytes/cycle", bytes_per_cycle);
+  }
+}
+
+// x86 only: cache line flushes and sfence have no portable equivalent.
+#ifdef __SSE2__
+// a = s, cache line by cache line; Flush::line(p) follows the stores to the
+// line at p.  clflushopt and clwb are weakly ordered, sfence waits for them.
+struct keep_line {
+  static void line(void*) {}
+};
+struct clflush_line {
+  static void line(void* p) { _mm_clflush(p); }
+};
+#ifdef __CLFLUSHOPT__
+struct clflushopt_line {
+  static void line(void* p) { _mm_clflushopt(p); }
+};
+#endif
+#ifdef __CLWB__
+struct clwb_line {
+  static void line(void* p) { _mm_clwb(p); }
+};
+#endif
+
+template <typename Flush>
+KERNEL static double store_lines_kernel(double* a, const size_t n) {
+  using V = widest_ops;
+  const auto s = V::set1(stream_scalar);
+  const auto line = cache_line_size / sizeof(double);
+  KERNEL_LOOP
+  for (size_t i = 0; i < n; i += line) {
+    for (size_t j = i; j < i + line; j += V::width) {
+      V::store(a + j, s);
+    }
+    Flush::line(a + i);
+  }
+  _mm_sfence();
+  return a[0];
+}
+
+// a = s with non-temporal stores: write-combined into whole lines that go to
+// memory without a read for ownership, and evict a's lines from the caches.
+KERNEL static double stream_lines_kernel(double* a, const size_t n) {
+  using V = widest_ops;
+  const auto s = V::set1(stream_scalar);
+  KERNEL_LOOP
+  for (size_t i = 0; i < n; i += V::width) {
+    V::stream(a + i, s);
+  }
+  _mm_sfence();
+  return a[0];
+}
+
+struct store_kind {
+  const char* name;
+  double (*kernel)(double* a, size_t n);
+};
+static const store_kind store_kinds[] = {
+    {"store", store_lines_kernel<keep_line>},
+    {"nt_store", stream_lines_kernel},
+    {"clflush", store_lines_kernel<clflush_line>},
+#ifdef __CLFLUSHOPT__
+    {"clflushopt", store_lines_kernel<clflushopt_line>},
+#endif
+#ifdef __CLWB__
+    {"clwb", store_lines_kernel<clwb_line>},
+#endif
+};
+
+// write bandwidth of regular stores vs non-temporal stores vs stores and a
+// flush of every line, over buffers from 4KiB to memory_chunk.  Regular
+// stores win while the buffer stays in the caches; past some size skipping
+// the read for ownership and the pollution of the caches pays.
+static void nt_stores(const argh::parser& cmdline, std::ostream* outstream) {
+  const auto sizes =
+      log_spaced(4 * KiB, memory_chunk, points_per_octave_param(cmdline, 1),
+                 PAGESIZE);
+  mapping buffer(memory_chunk, pages_param(cmdline));
+  const auto a = reinterpret_cast<double*>(buffer.data);
+  std::fill(a, a + memory_chunk / sizeof(double), 1.0);
+
+  // gbs[size][kind]
+  std::vector<std::vector<double>> gbs;
+  for (const auto size : sizes) {
+    ankerl::nanobench::Bench writes;
+    writes.title(size_string(size) + " writes").unit("byte").batch(size)
+        .output(outstream);
+    if (size > L3_cache_size) {
+      writes.epochs(1).epochIterations(1);
+    }
+    gbs.emplace_back();
+    for (const auto& kind : store_kinds) {
+      writes.run(size_string(size) + "_" + kind.name, [&] {
+        ankerl::nanobench::doNotOptimizeAway(
+            kind.kernel(a, size / sizeof(double)));
+      });
+      gbs.back().push_back(1 / latency_per_element(writes.results().back(),
+                                                   size));
+    }
+  }
+
+  // columns from store_kinds[first] on.
+  auto print_table = [&](const char* unit, const size_t first, auto cell) {
+    ::printf("\n%-30s", unit);
+    for (size_t k = first; k < std::size(store_kinds); ++k) {
+      ::printf(" %10s", store_kinds[k].name);
+    }
+    ::printf("\n");
+    for (size_t i = 0; i < sizes.size(); ++i) {
+      ::printf("%-30s", ("nt_stores_" + size_string(sizes[i])).c_str());
+      for (size_t k = first; k < std::size(store_kinds); ++k) {
+        ::printf(" %10.1f", cell(i, k));
+      }
+      ::printf("\n");
+    }
+  };
+  print_table("GB/s", 0, [&](size_t i, size_t k) { return gbs[i][k]; });
+  print_table("extra ns/line over store", 1, [&](size_t i, size_t k) {
+    return cache_line_size * (1 / gbs[i][k] - 1 / gbs[i][0]);
+  });
+
+  size_t crossover = 0;
+  for (size_t i = sizes.size(); i-- > 0 && gbs[i][1] > gbs[i][0];) {
+    crossover = sizes[i];
+  }
+  if (crossover != 0) {
+    ::printf("\n(non-temporal stores beat regular stores from %s.)\n",
+             size_string(crossover).c_str());
+  } else {
+    ::printf("\n(non-temporal stores never beat regular stores.)\n");
+  }
+}
+#endif
+
+// index of the kernel called name in bandwidth_kernels, or -1.
+static int find_kernel(const std::string& name) {
+  for (size_t k = 0; k < std::size(bandwidth_kernels); ++k) {
+    if (name == bandwidth_kernels[k].name) {
+      return k;
+    }
+  }
+  ::fprintf(stderr, "warning: ignoring --kernel=%s.\n", name.c_str());
+  return -1;
+}
+
+// bind memory the calling thread touches from now on to node, or unbind it
+// if node < 0.  Raw set_mempolicy(2) instead of libnuma.
+static bool bind_memory(const int node) {
+  if (node < 0) {
+    return ::syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0) == 0;
+  }
+  constexpr size_t bits = CHAR_BIT * sizeof(unsigned long);
+  std::vector<unsigned long> mask(node / bits + 1);
+  mask[node / bits] |= 1UL << node % bits;
+  return ::syscall(SYS_set_mempolicy, MPOL_BIND, mask.data(),
+                   mask.size() * bits + 1) == 0;
+}
+
+struct parallel_bandwidth_result {
+  double aggregate;   // GB/s of all threads from the first start to last end
+  double per_thread;  // mean GB/s of a thread
+  double slowest;     // GB/s of the slowest thread
+};
+
+// threads pinned to ids allocate and first-touch arrays of bytes each (on
+// node if it is not negative), then run the widest variant of kernel k over
+// them at once.
+static parallel_bandwidth_result parallel_bandwidth(const std::vector<int>& ids,
+                                                    const size_t k,
+                                                    const size_t bytes,
+                                                    const pages backing,
+                                                    const int node = -1) {
+  static constexpr size_t passes = 4;
+  const auto run = std::end(bandwidth_variants)[-1].kernels[k];
+  const auto n = ids.size();
+  std::vector<std::unique_ptr<stream_arrays>> arrays(n);
+  std::vector<std::chrono::steady_clock::time_point> begins(n), ends(n);
+  run_pinned(
+      ids,
+      [&](const size_t i) {
+        if (node >= 0 && !bind_memory(node)) {
+          ::fprintf(stderr, "warning: cannot bind memory to node %d.\n",
+                    node);
+        }
+        arrays[i] = std::make_unique<stream_arrays>(bytes, backing);
+        auto& a = *arrays[i];
+        ankerl::nanobench::doNotOptimizeAway(run(a.a, a.b, a.c, a.n));
+        if (node >= 0) {
+          bind_memory(-1);
+        }
+      },
+      [&](const size_t i) {
+        auto& a = *arrays[i];
+        begins[i] = std::chrono::steady_clock::now();
+        for (size_t pass = 0; pass < passes; ++pass) {
+          ankerl::nanobench::doNotOptimizeAway(run(a.a, a.b, a.c, a.n));
+        }
+        ends[i] = std::chrono::steady_clock::now();
+      });
+  const double moved = arrays[0]->n * bandwidth_kernels[k].bytes * passes;
+  const std::chrono::duration<double, std::nano> wall =
+      *std::max_element(ends.begin(), ends.end()) -
+      *std::min_element(begins.begin(), begins.end());
+  parallel_bandwidth_result r{n * moved / wall.count(), 0, 0};
+  for (size_t i = 0; i < n; ++i) {
+    const std::chrono::duration<double, std::nano> t = ends[i] - begins[i];
+    r.per_thread += moved / t.count() / n;
+    r.slowest = i == 0 ? moved / t.count() : std::min(r.slowest, moved / t.count());
+  }
+  return r;
+}
+
+// thread counts 1, 2, 4, 5, 8, 11, ... up to --threads=N (default: all cs).
+static std::vector<size_t> thread_counts_param(const argh::parser& cmdline,
+                                               const std::vector<cpu>& cs) {
+  size_t most_threads;
+  cmdline("--threads", cs.size()) >> most_threads;
+  most_threads = std::clamp(most_threads, size_t{1}, cs.size());
+  auto counts = log_spaced(1, most_threads, 2, 1);
+  if (counts.back() != most_threads) {
+    counts.push_back(most_threads);
+  }
+  return counts;
+}
+
+// multi-threaded bandwidth: 1 to --threads=N threads pinned in --placement
+// order (compact, scatter or both) run a --kernel at once with the widest
+// variant, each over its own arrays of 1/N of "memory" allocated (and so
+// first touched) by the thread itself.
+static void bandwidth_scaling(const argh::parser& cmdline, std::ostream*) {
+  const auto all = cpus(cmdline);
+  if (all.empty()) {
+    return;
+  }
+  const auto thread_counts = thread_counts_param(cmdline, all);
+  std::string kernels, placements;
+  cmdline("--kernel", "read,triad") >> kernels;
+  cmdline("--placement", "compact,scatter") >> placements;
+
+  for (const auto& order : split(placements)) {
+    if (order != "compact" && order != "scatter") {
+      ::fprintf(stderr, "warning: ignoring --placement=%s.\n", order.c_str());
+      continue;
+    }
+    const auto placed = placement(all, order == "scatter");
+    for (const auto& name : split(kernels)) {
+      const auto k = find_kernel(name);
+      if (k < 0) {
+        continue;
+      }
+      for (const auto n : thread_counts) {
+        std::vector<int> ids;
+        for (size_t i = 0; i < n; ++i) {
+          ids.push_back(placed[i].id);
+        }
+        const auto r =
+            parallel_bandwidth(ids, k, memory_chunk / n, pages_param(cmdline));
+        const auto row = order + "_" + name + "_" +
+                         std::to_string(n) + "_threads";
+        ::printf("%-30s %10.1f GB/s %10.1f GB/s/thread (min %.1f)\n",
+                 row.c_str(), r.aggregate, r.per_thread, r.slowest);
+      }
+    }
+  }
+}
+
+// loaded latency, like Intel MLC's: one thread chases a "memory" chain while
+// the other threads (up to --threads=N in compact order) run a --kernel in
+// blocks with a delay after each, from paused through long delays to none.
+// Bandwidth is what the other threads moved while the chase ran.
+static void loaded_latency(const argh::parser& cmdline, std::ostream*) {
+  static constexpr size_t block = 8 * KiB / sizeof(double);
+  static constexpr size_t max_hops = size_t{1} << 22;
+  static constexpr long paused = -1;
+  static constexpr long delays_ns[] = {paused, 20000, 10000, 5000, 2000,
+                                       1000,   500,   200,   100,  0};
+  const auto placed = placement(cpus(cmdline), false);
+  if (placed.empty()) {
+    return;
+  }
+  size_t n;
+  cmdline("--threads", placed.size()) >> n;
+  n = std::clamp(n, size_t{1}, placed.size());
+  if (n == 1) {
+    ::fprintf(stderr, "warning: no CPU left to load memory.\n");
+  }
+  std::string name;
+  cmdline("--kernel", "read") >> name;
+  const auto k = find_kernel(name);
+  if (k < 0) {
+    return;
+  }
+  const auto run = std::end(bandwidth_variants)[-1].kernels[k];
+  const auto backing = pages_param(cmdline);
+
+  std::vector<int> ids;
+  for (size_t i = 0; i < n; ++i) {
+    ids.push_back(placed[i].id);
+  }
+  struct alignas(64) counter {
+    std::atomic<uint64_t> bytes{0};
+  };
+  std::vector<counter> moved(n);
+  std::atomic<long> delay{paused};
+  std::atomic<bool> stop{false};
+  std::vector<std::unique_ptr<stream_arrays>> arrays(n);
+  chain memory{page_allocator<void*>{backing}};
+  std::vector<double> latency, bandwidth;
+
+  run_pinned(
+      ids,
+      [&](const size_t i) {
+        if (i == 0) {
+          create_random_chain(memory, memory_chunk);
+        } else {
+          arrays[i] = std::make_unique<stream_arrays>(
+              std::max(memory_chunk / (n - 1), 4 * L2_cache_size), backing);
+        }
+      },
+      [&](const size_t i) {
+        if (i != 0) {
+          auto& a = *arrays[i];
+          for (size_t j = 0; !stop.load(std::memory_order_relaxed);
+               j = (j + block) % a.n) {
+            const auto d = delay.load(std::memory_order_relaxed);
+            if (d == paused) {
+              continue;
+            }
+            ankerl::nanobench::doNotOptimizeAway(
+                run(a.a + j, a.b + j, a.c + j, std::min(block, a.n - j)));
+            moved[i].bytes.fetch_add(std::min(block, a.n - j) *
+                                         bandwidth_kernels[k].bytes,
+                                     std::memory_order_relaxed);
+            const auto until = std::chrono::steady_clock::now() +
+                               std::chrono::nanoseconds(d);
+            while (std::chrono::steady_clock::now() < until) {
+            }
+          }
+          return;
+        }
+        const auto hops = std::min(memory.size(), max_hops);
+        void* const* x = &memory[0];
+        for (const auto d : delays_ns) {
+          delay.store(d);
+          std::this_thread::sleep_for(std::chrono::milliseconds(50));
+          uint64_t before = 0, after = 0;
+          for (auto& m : moved) {
+            before += m.bytes.load();
+          }
+          const auto begin = std::chrono::steady_clock::now();
+          x = reinterpret_cast<void* const*>(chase_pointers(x, hops));
+          ankerl::nanobench::doNotOptimizeAway(x);
+          const std::chrono::duration<double, std::nano> t =
+              std::chrono::steady_clock::now() - begin;
+          for (auto& m : moved) {
+            after += m.bytes.load();
+          }
+          latency.push_back(t.count() / hops);
+          bandwidth.push_back((after - before) / t.count());
+        }
+        stop.store(true);
+      });
+
+  for (size_t i = 0; i < std::size(delays_ns); ++i) {
+    const auto row = delays_ns[i] == paused
+                         ? std::string("loaded_latency_idle")
+                         : "loaded_latency_delay_" +
+                               std::to_string(delays_ns[i]) + "ns";
+    ::printf("%-30s %10.1f ns %10.1f GB/s\n", row.c_str(), latency[i],
+             bandwidth[i]);
+  }
+}
+
+// node x node latency and bandwidth: from CPUs of each node (rows), chase a
+// "memory" chain on one CPU and run --kernel=read on up to --threads=N CPUs of
+// the node, over memory bound to each node with memory (columns).
+static void numa(const argh::parser& cmdline, std::ostream* outstream) {
+  const auto cs = cpus(cmdline);
+  if (cs.empty()) {
+    return;
+  }
+  std::map<int, std::vector<int>> cpus_of_node;
+  for (const auto& c : placement(cs, false)) {
+    cpus_of_node[c.node].push_back(c.id);
+  }
+  auto memory_nodes =
+      parse_cpulist(read_line("/sys/devices/system/node/has_memory"));
+  if (memory_nodes.empty()) {
+    memory_nodes.push_back(0);
+  }
+  size_t most_threads;
+  cmdline("--threads", cs.size()) >> most_threads;
+  most_threads = std::clamp(most_threads, size_t{1}, cs.size());
+  std::string name;
+  cmdline("--kernel", "read") >> name;
+  const auto k = find_kernel(name);
+  if (k < 0) {
+    return;
+  }
+  const auto backing = pages_param(cmdline);
+
+  // latency[cpu node][memory node], bandwidth[cpu node][memory node]
+  std::map<int, std::map<int, double>> latency, bandwidth;
+  ankerl::nanobench::Bench random_access;
+  random_access.title("numa random access").epochs(1).epochIterations(1)
+      .output(outstream);
+  for (const auto& [cpu_node, ids] : cpus_of_node) {
+    for (const auto memory_node : memory_nodes) {
+      chain memory{page_allocator<void*>{backing}};
+      run_pinned(
+          {ids[0]},
+          [&](size_t) {
+            if (!bind_memory(memory_node)) {
+              ::fprintf(stderr, "warning: cannot bind memory to node %d.\n",
+                        memory_node);
+            }
+            create_random_chain(memory, memory_chunk);
+            bind_memory(-1);
+          },
+          [&](size_t) {
+            random_access.run("cpu_node" + std::to_string(cpu_node) +
+                                  "_memory_node" + std::to_string(memory_node),
+                              [&] {
+                                ankerl::nanobench::doNotOptimizeAway(
+                                    chase_pointers(memory));
+                              });
+          });
+      latency[cpu_node][memory_node] = latency_per_element(
+          random_access.results().back(), memory.size());
+
+      std::vector<int> loaders(
+          ids.begin(), ids.begin() + std::min(ids.size(), most_threads));
+      bandwidth[cpu_node][memory_node] =
+          parallel_bandwidth(loaders, k, memory_chunk / loaders.size(),
+                             backing, memory_node)
+              .aggregate;
+    }
+  }
+
+  auto print_matrix = [&](const char* title,
+                          std::map<int, std::map<int, double>>& matrix) {
+    ::printf("\n%-30s", title);
+    for (const auto memory_node : memory_nodes) {
+      ::printf(" %9s", ("node" + std::to_string(memory_node)).c_str());
+    }
+    ::printf("\n");
+    for (const auto& [cpu_node, ids] : cpus_of_node) {
+      ::printf("%-30s", ("cpu_node" + std::to_string(cpu_node)).c_str());
+      for (const auto memory_node : memory_nodes) {
+        ::printf(" %9.1f", matrix[cpu_node][memory_node]);
+      }
+      ::printf("\n");
+    }
+  };
+  print_matrix("numa_latency_ns", latency);
+  print_matrix(("numa_" + name + "_GB/s").c_str(), bandwidth);
+  ::printf("(rows: CPUs on a node; columns: memory on a node.)\n");
+}
+
+// core-to-core latency: for every pair of CPUs, two pinned threads bounce
+// one cache line, each storing when it sees the other's store; best of three
+// runs of --round-trips=N round trips.  Summaries group pairs by how close
+// the CPUs sit: SMT siblings, same L3, same die, across dies of a package,
+// across packages.
+static void core_to_core(const argh::parser& cmdline, std::ostream*) {
+  const auto cs = placement(cpus(cmdline), false);
+  if (cs.size() < 2) {
+    ::fprintf(stderr, "warning: core to core latency needs 2 CPUs or more.\n");
+    return;
+  }
+  size_t round_trips;
+  cmdline("--round-trips", 10000) >> round_trips;
+  round_trips = std::max(round_trips, size_t{1});
+
+  struct alignas(64) line {
+    std::atomic<uint64_t> value;
+  };
+  auto ping_pong = [&](const cpu& a, const cpu& b) {
+    auto best = std::numeric_limits<double>::max();
+    for (int run = 0; run < 3; ++run) {
+      line l{{0}};
+      std::chrono::duration<double, std::nano> t{};
+      run_pinned(
+          {a.id, b.id}, [](size_t) {},
+          [&](const size_t i) {
+            if (i == 0) {
+              const auto begin = std::chrono::steady_clock::now();
+              for (uint64_t r = 0; r < round_trips; ++r) {
+                l.value.store(2 * r + 1, std::memory_order_release);
+                while (l.value.load(std::memory_order_acquire) != 2 * r + 2) {
+                }
+              }
+              t = std::chrono::steady_clock::now() - begin;
+            } else {
+              for (uint64_t r = 0; r < round_trips; ++r) {
+                while (l.value.load(std::memory_order_acquire) != 2 * r + 1) {
+                }
+                l.value.store(2 * r + 2, std::memory_order_release);
+              }
+            }
+          });
+      best = std::min(best, t.count() / round_trips);
+    }
+    return best;
+  };
+
+  const char* groups[] = {"smt_sibling", "same_l3", "same_die", "cross_die",
+                          "cross_package"};
+  auto group_of = [](const cpu& a, const cpu& b) {
+    if (a.package != b.package) {
+      return 4;
+    }
+    if (a.die != b.die) {
+      return 3;
+    }
+    if (a.core == b.core) {
+      return 0;
+    }
+    return a.l3 == b.l3 ? 1 : 2;
+  };
+  std::vector<std::vector<double>> ns(cs.size(),
+                                      std::vector<double>(cs.size()));
+  std::vector<std::vector<double>> grouped(std::size(groups));
+  for (size_t i = 0; i < cs.size(); ++i) {
+    for (size_t j = i + 1; j < cs.size(); ++j) {
+      ns[i][j] = ns[j][i] = ping_pong(cs[i], cs[j]);
+      grouped[group_of(cs[i], cs[j])].push_back(ns[i][j]);
+    }
+  }
+
+  ::printf("%-14s", "round_trip_ns");
+  for (const auto& c : cs) {
+    ::printf(" %6d", c.id);
+  }
+  ::printf("\n");
+  for (size_t i = 0; i < cs.size(); ++i) {
+    ::printf("%-14s", ("cpu" + std::to_string(cs[i].id)).c_str());
+    for (size_t j = 0; j < cs.size(); ++j) {
+      if (i == j) {
+        ::printf(" %6s", "-");
+      } else {
+        ::printf(" %6.0f", ns[i][j]);
+      }
+    }
+    ::printf("\n");
+  }
+  ::printf("\n");
+  for (size_t g = 0; g < std::size(groups); ++g) {
+    if (grouped[g].empty()) {
+      continue;
+    }
+    const auto [min, max] =
+        std::minmax_element(grouped[g].begin(), grouped[g].end());
+    const auto mean =
+        std::accumulate(grouped[g].begin(), grouped[g].end(), 0.0) /
+        grouped[g].size();
+    ::printf("%-30s %10.1f ns (min %.1f, max %.1f, %zu pairs)\n",
+             ("core_to_core_" + std::string(groups[g])).c_str(), mean, *min,
+             *max, grouped[g].size());
+  }
+}
+
+// p-th percentile of sorted xs.
+template <typename T>
+static T percentile(const std::vector<T>& xs, const double p) {
+  return xs.empty() ? T{} : xs[std::min(
+                                static_cast<size_t>(p / 100 * xs.size()),
+                                xs.size() - 1)];
+}
+
+// hand-off channels for --handoff: post(to, v) hands round v to thread `to`,
+// wait(me, v) returns once thread `me` got round v.  Each side's word sits
+// on its own cache line.
+struct alignas(64) handoff_word {
+  std::atomic<uint32_t> value{0};
+};
+
+static void futex_wait(std::atomic<uint32_t>* word, const uint32_t value) {
+  ::syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, value, nullptr, nullptr, 0);
+}
+
+static void futex_wake(std::atomic<uint32_t>* word) {
+  ::syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+// baseline: the waiter spins on the word, no kernel involved.
+struct busy_poll_channel {
+  handoff_word words[2];
+
+  void post(const int to, const uint32_t v) {
+    words[to].value.store(v, std::memory_order_release);
+  }
+  void wait(const int me, const uint32_t v) {
+    while (words[me].value.load(std::memory_order_acquire) != v) {
+      cpu_relax();
+    }
+  }
+};
+
+// raw futex: the waiter sleeps at once, every post is a FUTEX_WAKE.
+struct futex_channel {
+  handoff_word words[2];
+
+  void post(const int to, const uint32_t v) {
+    words[to].value.store(v, std::memory_order_release);
+    futex_wake(&words[to].value);
+  }
+  void wait(const int me, const uint32_t v) {
+    for (uint32_t x; (x = words[me].value.load(std::memory_order_acquire)) !=
+                     v;) {
+      futex_wait(&words[me].value, x);
+    }
+  }
+};
+
+// C++20's std::atomic<T>::wait/notify_one: how the standard library sleeps
+// and wakes (in libstdc++, a short spin, then a futex) is its own business.
+struct atomic_wait_channel {
+  handoff_word words[2];
+
+  void post(const int to, const uint32_t v) {
+    words[to].value.store(v, std::memory_order_release);
+    words[to].value.notify_one();
+  }
+  void wait(const int me, const uint32_t v) {
+    for (uint32_t x; (x = words[me].value.load(std::memory_order_acquire)) !=
+                     v;) {
+      words[me].value.wait(x, std::memory_order_acquire);
+    }
+  }
+};
+
+struct condvar_channel {
+  std::mutex m;
+  std::condition_variable cv[2];
+  uint32_t values[2] = {0, 0};
+
+  void post(const int to, const uint32_t v) {
+    {
+      const std::lock_guard<std::mutex> lock(m);
+      values[to] = v;
+    }
+    cv[to].notify_one();
+  }
+  void wait(const int me, const uint32_t v) {
+    std::unique_lock<std::mutex> lock(m);
+    cv[me].wait(lock, [&] { return values[me] == v; });
+  }
+};
+
+struct eventfd_channel {
+  int fds[2] = {::eventfd(0, EFD_CLOEXEC), ::eventfd(0, EFD_CLOEXEC)};
+
+  ~eventfd_channel() {
+    for (const auto fd : fds) {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+    }
+  }
+  bool ok() const { return fds[0] >= 0 && fds[1] >= 0; }
+  void post(const int to, uint32_t) {
+    const uint64_t one = 1;
+    [[maybe_unused]] const auto n = ::write(fds[to], &one, sizeof(one));
+    assert(n == sizeof(one));
+  }
+  void wait(const int me, uint32_t) {
+    uint64_t count;
+    [[maybe_unused]] const auto n = ::read(fds[me], &count, sizeof(count));
+    assert(n == sizeof(count));
+  }
+};
+
+struct pipe_channel {
+  int fds[2][2] = {{-1, -1}, {-1, -1}};
+
+  pipe_channel() {
+    for (auto& fd : fds) {
+      if (::pipe(fd) != 0) {
+        fd[0] = fd[1] = -1;
+      }
+    }
+  }
+  ~pipe_channel() {
+    for (const auto& fd : fds) {
+      for (const auto end : fd) {
+        if (end >= 0) {
+          ::close(end);
+        }
+      }
+    }
+  }
+  bool ok() const { return fds[0][0] >= 0 && fds[1][0] >= 0; }
+  void post(const int to, uint32_t) {
+    const char c = 0;
+    [[maybe_unused]] const auto n = ::write(fds[to][1], &c, 1);
+    assert(n == 1);
+  }
+  void wait(const int me, uint32_t) {
+    char c;
+    [[maybe_unused]] const auto n = ::read(fds[me][0], &c, 1);
+    assert(n == 1);
+  }
+};
+
+template <typename Channel, typename = void>
+struct channel_check {
+  static bool ok(const Channel&) { return true; }
+};
+template <typename Channel>
+struct channel_check<Channel,
+                     std::void_t<decltype(std::declval<Channel>().ok())>> {
+  static bool ok(const Channel& c) { return c.ok(); }
+};
+
+// sorted ns of round_trips round trips between threads pinned to a and b:
+// a posts to b, b posts back.  Empty if the channel could not be set up.
+template <typename Channel>
+static std::vector<double> handoff_round_trips(const int a, const int b,
+                                               const size_t round_trips) {
+  Channel channel;
+  if (!channel_check<Channel>::ok(channel)) {
+    ::fprintf(stderr, "warning: hand-off channel setup failed: %s.\n",
+              std::strerror(errno));
+    return {};
+  }
+  std::vector<double> ns(round_trips);
+  run_pinned({a, b}, [](size_t) {}, [&](const size_t i) {
+    for (size_t r = 1; r <= round_trips; ++r) {
+      // futex words are 32 bits; consecutive round trips still differ.
+      const auto v = static_cast<uint32_t>(r);
+      if (i == 0) {
+        const auto start = std::chrono::steady_clock::now();
+        channel.post(1, v);
+        channel.wait(0, v);
+        ns[r - 1] = std::chrono::duration<double, std::nano>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+      } else {
+        channel.wait(1, v);
+        channel.post(0, v);
+      }
+    }
+  });
+  std::sort(ns.begin(), ns.end());
+  return ns;
+}
+
+// thread hand-off latency: two threads on different cores (sharing an L3 if
+// possible) wake each other up --round-trips=N times through each channel;
+// prints round-trip percentiles and a histogram of round trips.
+static void handoff(const argh::parser& cmdline, std::ostream*) {
+  const auto cs = placement(cpus(cmdline), false);
+  if (cs.size() < 2) {
+    ::fprintf(stderr, "warning: hand-off latency needs 2 CPUs or more.\n");
+    return;
+  }
+  size_t round_trips;
+  cmdline("--round-trips", 10000) >> round_trips;
+  round_trips = std::max(round_trips, size_t{1});
+  auto other = cs.begin() + 1;
+  for (auto c = other; c != cs.end(); ++c) {
+    if (c->core != cs[0].core || c->die != cs[0].die ||
+        c->package != cs[0].package) {
+      other = c;
+      break;
+    }
+  }
+  const auto a = cs[0].id, b = other->id;
+
+  struct channel_row {
+    const char* name;
+    std::vector<double> (*run)(int a, int b, size_t round_trips);
+  };
+  const channel_row rows[] = {
+      {"busy_poll", handoff_round_trips<busy_poll_channel>},
+      {"atomic_wait", handoff_round_trips<atomic_wait_channel>},
+      {"futex", handoff_round_trips<futex_channel>},
+      {"condvar", handoff_round_trips<condvar_channel>},
+      {"eventfd", handoff_round_trips<eventfd_channel>},
+      {"pipe", handoff_round_trips<pipe_channel>},
+  };
+  // histogram buckets: round trips below 250 ns, 500 ns, 1 us, ... 128 us,
+  // and the rest.
+  constexpr size_t buckets = 11;
+  std::vector<std::vector<double>> results;
+  for (const auto& row : rows) {
+    results.push_back(row.run(a, b, round_trips));
+  }
+
+  ::printf("%-30s %9s %9s %9s %9s %9s %9s\n", "round_trip_ns", "min", "p50",
+           "p90", "p99", "p99.9", "max");
+  for (size_t r = 0; r < std::size(rows); ++r) {
+    const auto& ns = results[r];
+    if (ns.empty()) {
+      continue;
+    }
+    ::printf("%-30s %9.0f %9.0f %9.0f %9.0f %9.0f %9.0f\n",
+             ("handoff_" + std::string(rows[r].name)).c_str(), ns.front(),
+             percentile(ns, 50), percentile(ns, 90), percentile(ns, 99),
+             percentile(ns, 99.9), ns.back());
+  }
+
+  ::printf("\n%-30s", "round_trips_%_below");
+  for (size_t k = 0; k < buckets; ++k) {
+    const auto limit = 250.0 * (1 << k);
+    if (k + 1 == buckets) {
+      ::printf(" %6s", "more");
+    } else if (limit < 1000) {
+      ::printf(" %4.0fns", limit);
+    } else {
+      ::printf(" %4.0fus", limit / 1000);
+    }
+  }
+  ::printf("\n");
+  for (size_t r = 0; r < std::size(rows); ++r) {
+    const auto& ns = results[r];
+    if (ns.empty()) {
+      continue;
+    }
+    ::printf("%-30s", ("handoff_" + std::string(rows[r].name)).c_str());
+    auto from = ns.begin();
+    for (size_t k = 0; k < buckets; ++k) {
+      const auto to = k + 1 == buckets
+                          ? ns.end()
+                          : std::lower_bound(from, ns.end(), 250.0 * (1 << k));
+      ::printf(" %6.1f", 100.0 * (to - from) / ns.size());
+      from = to;
+    }
+    ::printf("\n");
+  }
+  ::printf("(CPUs %d and %d.)\n", a, b);
+}
+
+// false sharing: each of N threads increments its own counter, counters
+// packed next to each other (in one cache line up to 8 threads), padded to
+// a cache line, or padded to 128 bytes, against the adjacent line prefetcher
+// pulling in pairs of lines.
+static void false_sharing(const argh::parser& cmdline, std::ostream*) {
+  static constexpr uint64_t increments = uint64_t{1} << 20;
+  const auto cs = placement(cpus(cmdline), false);
+  if (cs.empty()) {
+    return;
+  }
+  const std::pair<std::string, size_t> layouts[] = {
+      {"packed", sizeof(uint64_t)},
+      {"padded_" + std::to_string(cache_line_size), cache_line_size},
+      {"padded_128", 128}};
+  for (const auto n : thread_counts_param(cmdline, cs)) {
+    std::vector<int> ids;
+    for (size_t i = 0; i < n; ++i) {
+      ids.push_back(cs[i].id);
+    }
+    for (const auto& [layout, stride] : layouts) {
+      mapping counters(n * stride);
+      std::vector<std::chrono::steady_clock::time_point> begins(n), ends(n);
+      run_pinned(
+          ids, [](size_t) {},
+          [&](const size_t i) {
+            // a plain counter that the compiler may not keep in a register.
+            auto& c = *new (counters.data + i * stride) std::atomic<uint64_t>{0};
+            begins[i] = std::chrono::steady_clock::now();
+            for (uint64_t k = 0; k < increments; ++k) {
+              c.store(c.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_relaxed);
+            }
+            ends[i] = std::chrono::steady_clock::now();
+          });
+      const std::chrono::duration<double, std::nano> wall =
+          *std::max_element(ends.begin(), ends.end()) -
+          *std::min_element(begins.begin(), begins.end());
+      double ns = 0;
+      for (size_t i = 0; i < n; ++i) {
+        ns += std::chrono::duration<double, std::nano>(ends[i] - begins[i])
+                  .count() /
+              increments / n;
+      }
+      const auto row = layout + "_" + std::to_string(n) + "_threads";
+      ::printf("%-30s %10.1f ns/increment %10.1f M increments/s\n",
+               row.c_str(), ns, n * increments / wall.count() * 1e3);
+    }
+  }
+}
+
+// spin for ns nanoseconds, if any.
+static void spin_for(const long ns) {
+  if (ns <= 0) {
+    return;
+  }
+  const auto until =
+      std::chrono::steady_clock::now() + std::chrono::nanoseconds(ns);
+  while (std::chrono::steady_clock::now() < until) {
+  }
+}
+
+// ns two back-to-back steady_clock reads take (median of many): the part of
+// a timed interval that is the timing itself.
+static int64_t clock_read_ns() {
+  static const auto ns = [] {
+    std::vector<int64_t> ns(10000);
+    for (auto& x : ns) {
+      const auto before = std::chrono::steady_clock::now();
+      x = std::chrono::nanoseconds(std::chrono::steady_clock::now() - before)
+              .count();
+    }
+    std::sort(ns.begin(), ns.end());
+    return percentile(ns, 50);
+  }();
+  return ns;
+}
+
+// contended mutex_access: 1 to --threads=N threads pinned in compact order
+// lock m, ++mi, spin --critical-ns, unlock, spin --think-ns (default: 0, 0)
+// for --duration-ms (default: 200).  Acquire latency is the time lock()
+// takes, less that of the clock reads around it, recorded for up to
+// max_samples acquisitions per thread.
+static void contended_mutex(const argh::parser& cmdline, std::ostream*) {
+  static constexpr size_t max_samples = size_t{1} << 20;
+  const auto cs = placement(cpus(cmdline), false);
+  if (cs.empty()) {
+    return;
+  }
+  long critical_ns, think_ns, duration_ms;
+  cmdline("--critical-ns", 0) >> critical_ns;
+  cmdline("--think-ns", 0) >> think_ns;
+  cmdline("--duration-ms", 200) >> duration_ms;
+  const auto clock_ns = clock_read_ns();
+
+  ::printf("%-30s %10s %8s %8s %8s %10s\n", "", "Mops/s", "p50 ns",
+           "p99 ns", "p99.9 ns", "min/max");
+  // acquisitions of each thread, per thread count.
+  std::vector<std::vector<uint64_t>> acquisitions;
+  for (const auto n : thread_counts_param(cmdline, cs)) {
+    std::vector<int> ids;
+    for (size_t i = 0; i < n; ++i) {
+      ids.push_back(cs[i].id);
+    }
+    std::vector<uint64_t> ops(n);
+    std::vector<std::vector<uint32_t>> waits(n);
+    std::atomic<bool> stop{false};
+    std::chrono::steady_clock::time_point begin, end;
+    run_pinned(
+        ids, [&](const size_t i) { waits[i].reserve(max_samples); },
+        [&](const size_t i) {
+          const auto deadline = std::chrono::steady_clock::now() +
+                                std::chrono::milliseconds(duration_ms);
+          if (i == 0) {
+            begin = std::chrono::steady_clock::now();
+          }
+          uint64_t k = 0;
+          for (; !stop.load(std::memory_order_relaxed); ++k) {
+            const auto before = std::chrono::steady_clock::now();
+            m.lock();
+            const auto acquired = std::chrono::steady_clock::now();
+            ++mi;
+            spin_for(critical_ns);
+            m.unlock();
+            if (waits[i].size() < max_samples) {
+              waits[i].push_back(static_cast<uint32_t>(std::clamp<int64_t>(
+                  std::chrono::nanoseconds(acquired - before).count() -
+                      clock_ns,
+                  0, UINT32_MAX)));
+            }
+            spin_for(think_ns);
+            if (i == 0 && acquired > deadline) {
+              stop.store(true);
+              end = acquired;
+            }
+          }
+          ops[i] = k;
+        });
+
+    std::vector<uint32_t> all;
+    for (const auto& w : waits) {
+      all.insert(all.end(), w.begin(), w.end());
+    }
+    std::sort(all.begin(), all.end());
+    const auto [fewest, most] = std::minmax_element(ops.begin(), ops.end());
+    const std::chrono::duration<double, std::micro> wall = end - begin;
+    ::printf("%-30s %10.2f %8u %8u %8u %10.2f\n",
+             ("contended_mutex_" + std::to_string(n) + "_threads").c_str(),
+             std::accumulate(ops.begin(), ops.end(), uint64_t{0}) /
+                 wall.count(),
+             percentile(all, 50), percentile(all, 99), percentile(all, 99.9),
+             static_cast<double>(*fewest) / *most);
+    acquisitions.push_back(ops);
+  }
+  ::printf("(critical section %ld ns, think time %ld ns; latencies less %ld "
+           "ns of clock reads; min/max: ops of the least over the most "
+           "served thread.)\n",
+           critical_ns, think_ns, static_cast<long>(clock_ns));
+
+  ::printf("\nacquisitions per thread, in CPU order:\n");
+  for (const auto& ops : acquisitions) {
+    ::printf("%-30s",
+             ("contended_mutex_" + std::to_string(ops.size()) + "_threads")
+                 .c_str());
+    for (size_t i = 0; i < ops.size(); ++i) {
+      if (i != 0 && i % 3 == 0) {
+        ::printf("\n%-30s", "");
+      }
+      ::printf(" %4d:%9lu", cs[i].id, static_cast<unsigned long>(ops[i]));
+    }
+    ::printf("\n");
+  }
+}
+
+// locks compared by --locks, besides std::mutex and std::shared_mutex.
+// Spinning waiters pause, to yield the core to an SMT sibling and not to
+// flood the memory system with loads.
+
+// test-and-test-and-set: waiters spin reading their cached copy of the line
+// and try to swap only once it looks free.
+struct ttas_lock {
+  std::atomic<bool> locked{false};
+
+  void lock() {
+    while (locked.exchange(true, std::memory_order_acquire)) {
+      while (locked.load(std::memory_order_relaxed)) {
+        cpu_relax();
+      }
+    }
+  }
+  void unlock() { locked.store(false, std::memory_order_release); }
+};
+
+// ticket lock: FIFO; every waiter spins on the same serving counter, so each
+// unlock invalidates all of their copies.
+struct ticket_lock {
+  std::atomic<uint32_t> next{0};
+  std::atomic<uint32_t> serving{0};
+
+  void lock() {
+    const auto ticket = next.fetch_add(1, std::memory_order_relaxed);
+    while (serving.load(std::memory_order_acquire) != ticket) {
+      cpu_relax();
+    }
+  }
+  void unlock() {
+    serving.store(serving.load(std::memory_order_relaxed) + 1,
+                  std::memory_order_release);
+  }
+};
+
+// MCS queue lock: FIFO; each waiter spins on a flag in its own queue node,
+// and unlock hands the lock to the next one, touching its line only.  The
+// node is per thread: a thread holds at most one MCS lock at a time here.
+struct mcs_lock {
+  struct alignas(64) node {
+    std::atomic<node*> next{nullptr};
+    std::atomic<bool> waiting{false};
+  };
+  std::atomic<node*> tail{nullptr};
+
+  static node& mine() {
+    thread_local node q;
+    return q;
+  }
+  void lock() {
+    auto& q = mine();
+    q.next.store(nullptr, std::memory_order_relaxed);
+    q.waiting.store(true, std::memory_order_relaxed);
+    const auto prev = tail.exchange(&q, std::memory_order_acq_rel);
+    if (prev != nullptr) {
+      prev->next.store(&q, std::memory_order_release);
+      while (q.waiting.load(std::memory_order_acquire)) {
+        cpu_relax();
+      }
+    }
+  }
+  void unlock() {
+    auto& q = mine();
+    auto next = q.next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      auto last = &q;
+      if (tail.compare_exchange_strong(last, nullptr,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+        return;
+      }
+      while ((next = q.next.load(std::memory_order_acquire)) == nullptr) {
+        cpu_relax();
+      }
+    }
+    next->waiting.store(false, std::memory_order_release);
+  }
+};
+
+// glibc's adaptive mutex: spins a while before sleeping in futex(2).
+struct adaptive_mutex {
+  pthread_mutex_t mutex;
+
+  adaptive_mutex() {
+    pthread_mutexattr_t attr;
+    ::pthread_mutexattr_init(&attr);
+    ::pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ADAPTIVE_NP);
+    ::pthread_mutex_init(&mutex, &attr);
+    ::pthread_mutexattr_destroy(&attr);
+  }
+  ~adaptive_mutex() { ::pthread_mutex_destroy(&mutex); }
+  adaptive_mutex(const adaptive_mutex&) = delete;
+  adaptive_mutex& operator=(const adaptive_mutex&) = delete;
+  void lock() { ::pthread_mutex_lock(&mutex); }
+  void unlock() { ::pthread_mutex_unlock(&mutex); }
+};
+
+// std::shared_mutex taken by readers: the critical section only reads.
+struct shared_reader {
+  static constexpr bool reads = true;
+  std::shared_mutex mutex;
+
+  void lock() { mutex.lock_shared(); }
+  void unlock() { mutex.unlock_shared(); }
+};
+
+template <typename L, typename = void>
+struct lock_reads : std::false_type {};
+template <typename L>
+struct lock_reads<L, std::void_t<decltype(L::reads)>>
+    : std::bool_constant<L::reads> {};
+
+// a lock and the value it protects, apart from other data.
+template <typename L>
+struct alignas(128) guarded {
+  L lock;
+  uint64_t value = 0;
+
+  // the critical section.
+  void touch() {
+    if constexpr (lock_reads<L>::value) {
+      ankerl::nanobench::doNotOptimizeAway(value);
+    } else {
+      ++value;
+    }
+  }
+  void access() {
+    lock.lock();
+    touch();
+    lock.unlock();
+  }
+};
+
+struct lock_params {
+  long critical_ns;
+  long think_ns;
+  long duration_ms;
+};
+
+// acquisitions per microsecond of threads on cpu ids, each locking g,
+// spinning critical_ns inside and think_ns outside, for duration_ms.
+template <typename L>
+static double lock_throughput(guarded<L>& g, const std::vector<int>& ids,
+                              const lock_params& params) {
+  std::vector<uint64_t> ops(ids.size());
+  std::atomic<bool> stop{false};
+  std::chrono::steady_clock::time_point begin, end;
+  run_pinned(ids, [](size_t) {}, [&](const size_t i) {
+    if (i == 0) {
+      begin = std::chrono::steady_clock::now();
+    }
+    const auto deadline = std::chrono::steady_clock::now() +
+                          std::chrono::milliseconds(params.duration_ms);
+    uint64_t k = 0;
+    for (; !stop.load(std::memory_order_relaxed); ++k) {
+      g.lock.lock();
+      g.touch();
+      spin_for(params.critical_ns);
+      g.lock.unlock();
+      spin_for(params.think_ns);
+      if (i == 0 && (k & 63) == 0 &&
+          std::chrono::steady_clock::now() > deadline) {
+        end = std::chrono::steady_clock::now();
+        stop.store(true);
+      }
+    }
+    ops[i] = k;
+  });
+  const std::chrono::duration<double, std::micro> wall = end - begin;
+  return std::accumulate(ops.begin(), ops.end(), uint64_t{0}) / wall.count();
+}
+
+// a row of the --locks table: ns per uncontended lock, access, unlock, and
+// Mops/s of each group of threads.
+template <typename L>
+static void lock_row(const char* name,
+                     const std::vector<std::vector<int>>& groups,
+                     const lock_params& params, std::ostream* outstream) {
+  guarded<L> g;
+  ankerl::nanobench::Bench uncontended;
+  uncontended.title("uncontended locks").output(outstream)
+      .run(std::string(name) + "_uncontended", [&] { g.access(); });
+  ::printf("%-30s %14.1f", name,
+           latency_per_element(uncontended.results().back(), 1));
+  for (const auto& ids : groups) {
+    if (ids.size() < 2) {
+      ::printf(" %20s", "-");
+    } else {
+      ::printf(" %20.2f", lock_throughput(g, ids, params));
+    }
+  }
+  ::printf("\n");
+}
+
+// lock comparison: uncontended ns per lock, access, unlock; Mops/s of up to
+// --threads=N threads on the CPUs sharing the L3 of the first one, and of as
+// many threads spread over sockets (scatter order), when there are several.
+// --critical-ns, --think-ns and --duration-ms as for --contended-mutex.
+static void locks(const argh::parser& cmdline, std::ostream* outstream) {
+  const auto all = cpus(cmdline);
+  if (all.empty()) {
+    return;
+  }
+  lock_params params;
+  cmdline("--critical-ns", 0) >> params.critical_ns;
+  cmdline("--think-ns", 0) >> params.think_ns;
+  cmdline("--duration-ms", 200) >> params.duration_ms;
+  size_t most_threads;
+  cmdline("--threads", all.size()) >> most_threads;
+
+  std::vector<int> same_l3, cross_socket;
+  const auto compact = placement(all, false);
+  for (const auto& c : compact) {
+    if (c.package == compact[0].package && c.l3 == compact[0].l3 &&
+        same_l3.size() < most_threads) {
+      same_l3.push_back(c.id);
+    }
+  }
+  std::set<int> packages;
+  for (const auto& c : placement(all, true)) {
+    if (cross_socket.size() < same_l3.size()) {
+      cross_socket.push_back(c.id);
+      packages.insert(c.package);
+    }
+  }
+  if (packages.size() < 2) {
+    cross_socket.clear();
+  }
+
+  ::printf("%-30s %14s %20s %20s\n", "", "uncontended ns",
+           ("Mops/s " + std::to_string(same_l3.size()) + " same L3").c_str(),
+           ("Mops/s " + std::to_string(cross_socket.size()) + " x-socket")
+               .c_str());
+  const std::vector<std::vector<int>> groups{same_l3, cross_socket};
+  lock_row<std::mutex>("std::mutex", groups, params, outstream);
+  lock_row<adaptive_mutex>("adaptive_mutex", groups, params, outstream);
+  lock_row<std::shared_mutex>("std::shared_mutex", groups, params, outstream);
+  lock_row<shared_reader>("std::shared_mutex_shared", groups, params,
+                          outstream);
+  lock_row<ttas_lock>("ttas_spinlock", groups, params, outstream);
+  lock_row<ticket_lock>("ticket_lock", groups, params, outstream);
+  lock_row<mcs_lock>("mcs_lock", groups, params, outstream);
+}
+
+// atomic operations for --atomics, each as a kernel doing count operations on
+// x, x + stride, x + 2 * stride, ...: stride 0 stays on one line.
+// A compare-exchange is a single attempt, successful or not.
+using atomic_word = std::atomic<uint64_t>;
+
+template <std::memory_order O>
+struct load_op {
+  static uint64_t run(atomic_word* x, uint64_t) { return x->load(O); }
+};
+template <std::memory_order O>
+struct store_op {
+  static uint64_t run(atomic_word* x, const uint64_t v) {
+    x->store(v, O);
+    return v;
+  }
+};
+template <std::memory_order O>
+struct fetch_add_op {
+  static uint64_t run(atomic_word* x, const uint64_t v) {
+    return x->fetch_add(v, O);
+  }
+};
+template <std::memory_order O>
+struct exchange_op {
+  static uint64_t run(atomic_word* x, const uint64_t v) {
+    return x->exchange(v, O);
+  }
+};
+template <std::memory_order O>
+struct cas_op {
+  static uint64_t run(atomic_word* x, uint64_t v) {
+    x->compare_exchange_strong(v, v + 1, O, std::memory_order_relaxed);
+    return v;
+  }
+};
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_16
+__extension__ using uint128 = unsigned __int128;
+
+// cmpxchg16b on the 16 bytes at x, always sequentially consistent.
+struct cas128_op {
+  static uint64_t run(atomic_word* x, const uint64_t v) {
+    return static_cast<uint64_t>(__sync_val_compare_and_swap(
+        reinterpret_cast<uint128*>(x), uint128{v}, uint128{v} + 1));
+  }
+};
+#endif
+
+template <typename Op>
+static uint64_t atomic_kernel(atomic_word* x, const size_t count,
+                              const size_t stride) {
+  uint64_t sum = 0;
+  for (size_t k = 0; k < count; ++k) {
+    sum += Op::run(x + k * stride, k);
+  }
+  return sum;
+}
+
+struct atomic_operation {
+  const char* name;
+  uint64_t (*kernel)(atomic_word* x, size_t count, size_t stride);
+};
+
+static constexpr auto relaxed = std::memory_order_relaxed;
+static constexpr auto acquire = std::memory_order_acquire;
+static constexpr auto release = std::memory_order_release;
+static constexpr auto acq_rel = std::memory_order_acq_rel;
+static constexpr auto seq_cst = std::memory_order_seq_cst;
+
+static const atomic_operation atomic_operations[] = {
+    {"load_relaxed", atomic_kernel<load_op<relaxed>>},
+    {"load_acquire", atomic_kernel<load_op<acquire>>},
+    {"load_seq_cst", atomic_kernel<load_op<seq_cst>>},
+    {"store_relaxed", atomic_kernel<store_op<relaxed>>},
+    {"store_release", atomic_kernel<store_op<release>>},
+    {"store_seq_cst", atomic_kernel<store_op<seq_cst>>},
+    {"fetch_add_relaxed", atomic_kernel<fetch_add_op<relaxed>>},
+    {"fetch_add_acq_rel", atomic_kernel<fetch_add_op<acq_rel>>},
+    {"fetch_add_seq_cst", atomic_kernel<fetch_add_op<seq_cst>>},
+    {"exchange_relaxed", atomic_kernel<exchange_op<relaxed>>},
+    {"exchange_acq_rel", atomic_kernel<exchange_op<acq_rel>>},
+    {"exchange_seq_cst", atomic_kernel<exchange_op<seq_cst>>},
+    {"cas_relaxed", atomic_kernel<cas_op<relaxed>>},
+    {"cas_acq_rel", atomic_kernel<cas_op<acq_rel>>},
+    {"cas_seq_cst", atomic_kernel<cas_op<seq_cst>>},
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_16
+    {"cas128_seq_cst", atomic_kernel<cas128_op>},
+#endif
+};
+
+// cost of atomic operations and memory orders:
+// - uncontended: one thread, repeatedly on a line in its L1,
+// - remote: on each of a batch of lines the next CPU (compact order) wrote
+//   last, so that the line comes from its cache,
+// - contended: --threads=N threads on one line, for --duration-ms each
+//   (default: 100).
+// Cycles of each row are derived from its uncontended run, if there are
+// counters.
+static void atomics(const argh::parser& cmdline, std::ostream* outstream) {
+  static constexpr size_t batch = 64;
+  static constexpr size_t rounds = 1000;
+  const auto cs = placement(cpus(cmdline), false);
+  if (cs.empty()) {
+    return;
+  }
+  size_t n;
+  cmdline("--threads", cs.size()) >> n;
+  n = std::clamp(n, size_t{1}, cs.size());
+  long duration_ms;
+  cmdline("--duration-ms", 100) >> duration_ms;
+  const auto words = cache_line_size / sizeof(atomic_word);
+  mapping lines(batch * cache_line_size);
+  const auto x = reinterpret_cast<atomic_word*>(lines.data);
+
+  // ns[operation][0: uncontended, 1: remote, 2: contended]
+  std::vector<std::array<double, 3>> ns(std::size(atomic_operations));
+  // per operation, from its own uncontended run: clocks may differ by kernel.
+  std::vector<double> cycles_per_ns(std::size(atomic_operations));
+  ankerl::nanobench::Bench uncontended;
+  uncontended.title("uncontended atomics").output(outstream).batch(batch);
+  for (size_t o = 0; o < std::size(atomic_operations); ++o) {
+    const auto kernel = atomic_operations[o].kernel;
+    uncontended.run(atomic_operations[o].name, [&] {
+      ankerl::nanobench::doNotOptimizeAway(kernel(x, batch, 0));
+    });
+    ns[o][0] = latency_per_element(uncontended.results().back(), batch);
+    cycles_per_ns[o] =
+        cpucycles_per_element(uncontended.results().back(), batch) / ns[o][0];
+  }
+
+  for (size_t o = 0; o < std::size(atomic_operations); ++o) {
+    const auto kernel = atomic_operations[o].kernel;
+    if (cs.size() >= 2) {
+      std::atomic<size_t> turn{0};
+      std::chrono::duration<double, std::nano> elapsed{0};
+      run_pinned({cs[0].id, cs[1].id}, [](size_t) {}, [&](const size_t i) {
+        for (size_t r = 0; r < rounds; ++r) {
+          while (turn.load(std::memory_order_acquire) != 2 * r + (i ^ 1)) {
+            cpu_relax();
+          }
+          if (i == 1) {
+            for (size_t k = 0; k < batch; ++k) {
+              x[k * words].store(r, std::memory_order_relaxed);
+            }
+          } else {
+            const auto start = std::chrono::steady_clock::now();
+            ankerl::nanobench::doNotOptimizeAway(kernel(x, batch, words));
+            elapsed += std::chrono::steady_clock::now() - start;
+          }
+          turn.store(2 * r + (i ^ 1) + 1, std::memory_order_release);
+        }
+      });
+      ns[o][1] = elapsed.count() / (rounds * batch);
+    }
+
+    if (n >= 2) {
+      std::vector<int> ids;
+      for (size_t i = 0; i < n; ++i) {
+        ids.push_back(cs[i].id);
+      }
+      std::vector<uint64_t> ops(n);
+      std::atomic<bool> stop{false};
+      std::chrono::steady_clock::time_point begin, end;
+      run_pinned(ids, [](size_t) {}, [&](const size_t i) {
+        // only thread 0 watches the clock, and only it touches begin.
+        std::chrono::steady_clock::time_point deadline;
+        if (i == 0) {
+          begin = std::chrono::steady_clock::now();
+          deadline = begin + std::chrono::milliseconds(duration_ms);
+        }
+        uint64_t k = 0;
+        for (; !stop.load(std::memory_order_relaxed); k += batch) {
+          ankerl::nanobench::doNotOptimizeAway(kernel(x, batch, 0));
+          if (i == 0 && std::chrono::steady_clock::now() > deadline) {
+            end = std::chrono::steady_clock::now();
+            stop.store(true);
+          }
+        }
+        ops[i] = k;
+      });
+      const std::chrono::duration<double, std::nano> wall = end - begin;
+      ns[o][2] = wall.count() * n /
+                 std::accumulate(ops.begin(), ops.end(), uint64_t{0});
+    }
+  }
+
+  auto print_table = [&](const char* unit, const std::vector<double>& scale) {
+    ::printf("\n%-30s %12s %12s %12s\n", unit, "uncontended", "remote",
+             ("contended " + std::to_string(n)).c_str());
+    for (size_t o = 0; o < std::size(atomic_operations); ++o) {
+      ::printf("%-30s",
+               ("atomic_" + std::string(atomic_operations[o].name)).c_str());
+      for (size_t j = 0; j < 3; ++j) {
+        if (ns[o][j] == 0 || !std::isnormal(scale[o])) {
+          ::printf(" %12s", "-");
+        } else {
+          ::printf(" %12.1f", ns[o][j] * scale[o]);
+        }
+      }
+      ::printf("\n");
+    }
+  };
+  print_table("ns per operation",
+              std::vector<double>(std::size(atomic_operations), 1));
+  if (std::any_of(cycles_per_ns.begin(), cycles_per_ns.end(),
+                  [](const double c) { return std::isnormal(c); })) {
+    print_table("cycles per operation", cycles_per_ns);
+  }
+}
+
+// TLB shootdowns: one thread maps, touches and unmaps fresh memory of a few
+// sizes while 0 to --threads=N minus one other threads of the process spin
+// on other CPUs in compact order.  Those CPUs may cache translations of the
+// unmapped pages, so munmap(2) must interrupt each of them (IPIs) and wait
+// until they have flushed their TLBs.
+static void shootdown(const argh::parser& cmdline, std::ostream*) {
+  static constexpr size_t sizes[] = {4 * KiB, 64 * KiB, MiB, 16 * MiB};
+  // enough rounds for 10 of them above p99.
+  static constexpr size_t rounds = 1000;
+  const auto cs = placement(cpus(cmdline), false);
+  if (cs.empty()) {
+    return;
+  }
+  ::printf("%-30s %12s %12s %12s\n", "ns", "mmap+touch", "munmap p50",
+           "munmap p99");
+  for (const auto n : thread_counts_param(cmdline, cs)) {
+    std::vector<int> ids;
+    for (size_t i = 0; i < n; ++i) {
+      ids.push_back(cs[i].id);
+    }
+    std::atomic<bool> stop{false};
+    // ns[size][0: mmap+touch, 1: munmap p50, 2: munmap p99]
+    std::vector<std::array<double, 3>> ns(std::size(sizes));
+    run_pinned(
+        ids, [](size_t) {},
+        [&](const size_t i) {
+          if (i != 0) {
+            while (!stop.load(std::memory_order_relaxed)) {
+            }
+            return;
+          }
+          for (size_t j = 0; j < std::size(sizes); ++j) {
+            std::vector<double> touch_ns, unmap_ns;
+            for (size_t round = 0; round < rounds; ++round) {
+              const auto start = std::chrono::steady_clock::now();
+              auto fresh = std::make_unique<mapping>(sizes[j]);
+              touch_pages(fresh->data, fresh->size);
+              const auto touched = std::chrono::steady_clock::now();
+              fresh.reset();
+              const auto unmapped = std::chrono::steady_clock::now();
+              touch_ns.push_back(std::chrono::duration<double, std::nano>(
+                                     touched - start).count());
+              unmap_ns.push_back(std::chrono::duration<double, std::nano>(
+                                     unmapped - touched).count());
+            }
+            std::sort(touch_ns.begin(), touch_ns.end());
+            std::sort(unmap_ns.begin(), unmap_ns.end());
+            ns[j] = {percentile(touch_ns, 50), percentile(unmap_ns, 50),
+                     percentile(unmap_ns, 99)};
+          }
+          stop.store(true);
+        });
+    for (size_t j = 0; j < std::size(sizes); ++j) {
+      ::printf("%-30s %12.0f %12.0f %12.0f\n",
+               ("shootdown_" + size_string(sizes[j]) + "_" +
+                std::to_string(n) + "_threads")
+                   .c_str(),
+               ns[j][0], ns[j][1], ns[j][2]);
+    }
+  }
+}
+
+// allocators compared by --allocators.  deallocate_remote(p) frees p from a
+// thread other than the one that allocated it.
+struct malloc_allocator {
+  malloc_allocator(size_t, size_t) {}
+  void* allocate(const size_t n) { return std::malloc(n); }
+  void deallocate(void* p) { std::free(p); }
+  void deallocate_remote(void* p) { std::free(p); }
+  void reset() {}
+};
+
+struct new_allocator {
+  new_allocator(size_t, size_t) {}
+  void* allocate(const size_t n) { return new char[n]; }
+  void deallocate(void* p) { delete[] static_cast<char*>(p); }
+  void deallocate_remote(void* p) { delete[] static_cast<char*>(p); }
+  void reset() {}
+};
+
+static constexpr size_t allocation_alignment = alignof(std::max_align_t);
+
+static size_t aligned_allocation(const size_t n) {
+  return (n + allocation_alignment - 1) / allocation_alignment *
+         allocation_alignment;
+}
+
+// bump arena for count allocations of up to size bytes: an allocation adds
+// to an offset, frees are no-ops, reset() frees everything at once.
+struct bump_arena {
+  mapping memory;
+  size_t used = 0;
+
+  bump_arena(const size_t size, const size_t count)
+      : memory(aligned_allocation(size) * count) {}
+  void* allocate(const size_t n) {
+    const auto p = memory.data + used;
+    used += aligned_allocation(n);
+    if (used > memory.size) {
+      throw std::bad_alloc();
+    }
+    return p;
+  }
+  void deallocate(void*) {}
+  void deallocate_remote(void*) {}
+  void reset() { used = 0; }
+};
+
+// fixed-size pool of count blocks of size bytes, a free list threaded
+// through the free blocks.  Only its thread allocates and frees locally;
+// other threads push remote frees on an atomic list, taken over as a whole
+// when the local one runs dry.
+struct fixed_pool {
+  struct block {
+    block* next;
+  };
+  mapping memory;
+  block* local = nullptr;
+  std::atomic<block*> remote{nullptr};
+
+  fixed_pool(const size_t size, const size_t count)
+      : memory(aligned_allocation(std::max(size, sizeof(block))) * count) {
+    const auto stride = memory.size / count;
+    for (size_t k = count; k-- > 0;) {
+      deallocate(memory.data + k * stride);
+    }
+  }
+  void* allocate(size_t) {
+    if (local == nullptr) {
+      local = remote.exchange(nullptr, std::memory_order_acquire);
+      if (local == nullptr) {
+        throw std::bad_alloc();
+      }
+    }
+    const auto b = local;
+    local = b->next;
+    return b;
+  }
+  void deallocate(void* p) {
+    const auto b = static_cast<block*>(p);
+    b->next = local;
+    local = b;
+  }
+  void deallocate_remote(void* p) {
+    const auto b = static_cast<block*>(p);
+    b->next = remote.load(std::memory_order_relaxed);
+    while (!remote.compare_exchange_weak(b->next, b, std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+    }
+  }
+  void reset() {}
+};
+
+// "VmRSS" or "VmHWM" (peak RSS) of /proc/self/status, in bytes.
+static size_t status_bytes(const std::string& field) {
+  std::ifstream status("/proc/self/status");
+  for (std::string line; std::getline(status, line);) {
+    if (line.rfind(field + ":", 0) == 0) {
+      return std::stoul(line.substr(field.size() + 1)) * KiB;
+    }
+  }
+  return 0;
+}
+
+// lower the peak RSS to the current RSS.
+static void reset_peak_rss() { std::ofstream("/proc/self/clear_refs") << "5"; }
+
+// threads wait in arrive_and_wait() until all n have arrived; reusable.
+struct spin_barrier {
+  const size_t n;
+  std::atomic<size_t> arrived{0};
+  std::atomic<size_t> generation{0};
+
+  explicit spin_barrier(const size_t threads) : n(threads) {}
+  void arrive_and_wait() {
+    const auto g = generation.load();
+    if (arrived.fetch_add(1) + 1 == n) {
+      arrived.store(0);
+      generation.fetch_add(1);
+      return;
+    }
+    while (generation.load() == g) {
+    }
+  }
+};
+
+static constexpr size_t allocation_sizes[] = {16,       64,       256,
+                                              KiB,      4 * KiB,  16 * KiB,
+                                              64 * KiB, 256 * KiB, MiB};
+
+// allocations in flight per thread: up to 16MiB, 16 to 1024 of them.
+static size_t allocations_of(const size_t size) {
+  return std::clamp(16 * MiB / size, size_t{16}, size_t{1024});
+}
+
+// ns per allocation and free, and peak RSS above the RSS before.
+struct allocation_row {
+  std::string name;
+  double ns;
+  size_t peak;
+};
+
+// peak RSS since reset_peak_rss() above rss, 0 if RSS shrank meanwhile.
+static size_t peak_rss_above(const size_t rss) {
+  const auto peak = status_bytes("VmHWM");
+  return peak > rss ? peak - rss : 0;
+}
+
+// rows of A at every size: a thread allocates count blocks, writes their
+// first byte, frees them all; then n >= 2 threads each allocate count blocks
+// that their neighbour frees, rounds at a time.
+template <typename A>
+static void allocation_rows(const char* name, const std::vector<cpu>& cs,
+                            const std::vector<size_t>& thread_counts,
+                            std::ostream* outstream,
+                            std::vector<allocation_row>& rows) {
+  static constexpr size_t rounds = 50;
+  for (const auto size : allocation_sizes) {
+    const auto count = allocations_of(size);
+    const auto row = std::string("alloc_") + name + "_" + size_string(size);
+    std::vector<void*> blocks(count);
+    const auto rss_before = status_bytes("VmRSS");
+    reset_peak_rss();
+    {
+      A a(size, count);
+      ankerl::nanobench::Bench allocation;
+      allocation.title(std::string(name) + " allocation").output(outstream)
+          .batch(count);
+      allocation.run(row, [&] {
+        for (auto& p : blocks) {
+          p = a.allocate(size);
+          *static_cast<char*>(p) = 1;
+        }
+        for (const auto p : blocks) {
+          a.deallocate(p);
+        }
+        a.reset();
+      });
+      rows.push_back(
+          {row, latency_per_element(allocation.results().back(), count),
+           peak_rss_above(rss_before)});
+    }
+
+    for (const auto n : thread_counts) {
+      if (n < 2) {
+        continue;
+      }
+      std::vector<int> ids;
+      for (size_t i = 0; i < n; ++i) {
+        ids.push_back(cs[i].id);
+      }
+      std::vector<std::unique_ptr<A>> as(n);
+      std::vector<std::vector<void*>> handed(n, std::vector<void*>(count));
+      spin_barrier barrier(n);
+      std::chrono::steady_clock::time_point begin, end;
+      const auto rss_before_threads = status_bytes("VmRSS");
+      reset_peak_rss();
+      run_pinned(
+          ids, [&](const size_t i) { as[i] = std::make_unique<A>(size, count); },
+          [&](const size_t i) {
+            auto& a = *as[i];
+            auto& neighbour = *as[(i + 1) % n];
+            if (i == 0) {
+              begin = std::chrono::steady_clock::now();
+            }
+            for (size_t round = 0; round < rounds; ++round) {
+              for (auto& p : handed[i]) {
+                p = a.allocate(size);
+                *static_cast<char*>(p) = 1;
+              }
+              barrier.arrive_and_wait();
+              for (const auto p : handed[(i + 1) % n]) {
+                neighbour.deallocate_remote(p);
+              }
+              barrier.arrive_and_wait();
+              a.reset();
+            }
+            if (i == 0) {
+              end = std::chrono::steady_clock::now();
+            }
+          });
+      rows.push_back(
+          {row + "_" + std::to_string(n) + "_threads",
+           std::chrono::duration<double, std::nano>(end - begin).count() /
+               (rounds * count),
+           peak_rss_above(rss_before_threads)});
+    }
+  }
+}
+
+// allocation cost of glibc malloc/free and new/delete vs a bump arena and a
+// fixed-size pool at sizes from 16B to 1MiB, from one thread and with frees
+// from other threads, 2 to --threads=N in compact order.
+static void allocators(const argh::parser& cmdline, std::ostream* outstream) {
+  const auto cs = placement(cpus(cmdline), false);
+  if (cs.empty()) {
+    return;
+  }
+  const auto thread_counts = thread_counts_param(cmdline, cs);
+  std::vector<allocation_row> rows;
+  allocation_rows<malloc_allocator>("malloc", cs, thread_counts, outstream,
+                                    rows);
+  allocation_rows<new_allocator>("new", cs, thread_counts, outstream, rows);
+  allocation_rows<bump_arena>("arena", cs, thread_counts, outstream, rows);
+  allocation_rows<fixed_pool>("pool", cs, thread_counts, outstream, rows);
+
+  if (outstream != nullptr) {
+    ::printf("\n");
+  }
+  for (const auto& row : rows) {
+    ::printf("%-30s %10.1f ns/alloc+free %10s peak RSS\n", row.name.c_str(),
+             row.ns, size_string(row.peak).c_str());
+  }
+}
+
+// modes run instead of the default set of benchmarks.
+struct mode {
+  const char* flag;
+  const char* help;
+  void (*run)(const argh::parser& cmdline, std::ostream* outstream);
+};
+static const mode modes[] = {
+    {"--sweep",
+     "latency of random access over log-spaced working sets from 4KiB\n"
+     "   to --max-size=SIZE (default: \"memory\" size) with\n"
+     "   --points-per-octave=N (default: 4), and the knees of the curve.",
+     sweep},
+    {"--hugepages",
+     "random access latency at L1, L2, L3, \"memory\" sizes on 4KiB\n"
+     "   pages, and its difference on transparent huge pages and on 2MiB\n"
+     "   and 1GiB hugetlb pages.\n"
+     "   (--pages=4KiB|thp|2MiB|1GiB sets pages of other measurements.)",
+     hugepages},
+    {"--page-faults",
+     "ns per page and GB/s of the first touch of --fault-size\n"
+     "   (default: 64MiB) of fresh memory on 4KiB, thp, 2MiB and 1GiB pages,\n"
+     "   faulted in by touch, by MADV_POPULATE_WRITE and by mlock(2); and of\n"
+     "   unmap.",
+     page_faults},
+    {"--tlb",
+     "latency of chains of one node per page and per --page-stride=N\n"
+     "   pages (default: 512) from 4 to --max-pages=N pages, and the extra\n"
+     "   cost over a compact chain of as many cache lines: TLB misses and\n"
+     "   page walks.",
+     tlb},
+    {"--mlp",
+     "effective latency of 1 to --max-chains=N (default: 32) independent\n"
+     "   random chains chased in lockstep at L1, L2, L3, \"memory\" sizes,\n"
+     "   and the implied cache misses outstanding per core.",
+     mlp},
+    {"--prefetch-distance",
+     "chase --hops=N (default: 4M) hops of a \"memory\" chain with\n"
+     "   a software prefetch of the node 1 to --max-distance (default: 32)\n"
+     "   hops ahead: speedup over the plain chase and the best distance.",
+     prefetch_distance},
+    {"--row-locality",
+     "latency of a \"memory\" chain visiting the lines of 4KiB, 8KiB,\n"
+     "   2MiB windows in random order, window after window, vs fully random:\n"
+     "   DRAM row buffer hits (transparent huge pages unless --pages).",
+     row_locality},
+    {"--stride",
+     "latency of chains of fixed strides from 8B to 4KiB and page-crossing\n"
+     "   strides over spans of L1, L2, L3, \"memory\" size, chased in\n"
+     "   address order vs random order: the reach of hardware prefetchers.",
+     stride},
+    {"--associativity",
+     "latency of chains of 1 to --max-ways (default: 32) nodes\n"
+     "   spaced 4KiB to 1MiB apart (transparent huge pages unless --pages):\n"
+     "   set conflicts and the associativity of each cache level.",
+     associativity},
+    {"--write-chase",
+     "pointer chase of one node per cache line at each level,\n"
+     "   read-only vs read-modify-write of every node vs a store to another\n"
+     "   line per hop: the cost of dirty lines, writebacks and read for\n"
+     "   ownership.",
+     write_chase},
+    {"--bandwidth",
+     "GB/s and bytes/cycle of STREAM-like read, write, copy, scale,\n"
+     "   triad kernels in scalar and SSE/AVX2/AVX-512 (as compiled) variants\n"
+     "   over arrays in L1, L2, L3 and \"memory\".",
+     bandwidth},
+#ifdef __SSE2__
+    {"--nt-stores",
+     "write GB/s of regular vs non-temporal stores vs stores followed by\n"
+     "   clflush/clflushopt/clwb of each line, 4KiB to \"memory\": extra\n"
+     "   ns per line and where non-temporal stores start to pay.",
+     nt_stores},
+#endif
+    {"--bandwidth-scaling",
+     "aggregate and per-thread GB/s of 1 to --threads=N threads\n"
+     "   pinned to --cpus=LIST (default: all allowed) in\n"
+     "   --placement=compact,scatter order, running --kernel=read,triad over\n"
+     "   \"memory\" at once.",
+     bandwidth_scaling},
+    {"--loaded-latency",
+     "\"memory\" random access latency of one thread while up to\n"
+     "   --threads=N-1 other threads load memory with --kernel=read (or\n"
+     "   write, copy, scale, triad) at several rates: latency vs bandwidth.",
+     loaded_latency},
+    {"--numa",
+     "node x node matrices of \"memory\" random access latency from one\n"
+     "   CPU, and of --kernel=read GB/s from up to --threads=N CPUs, of each\n"
+     "   node over memory bound to each node.",
+     numa},
+    {"--core-to-core",
+     "CPU x CPU matrix of round trip latency of a cache line bounced\n"
+     "   between two CPUs with atomic stores and loads (--round-trips=N,\n"
+     "   default: 10000), and summaries for SMT siblings, same L3, same die,\n"
+     "   across dies, and across packages.",
+     core_to_core},
+    {"--handoff",
+     "round-trip latency percentiles and histogram of two threads waking\n"
+     "   each other through busy polling, atomic wait, futex, condition\n"
+     "   variable, eventfd and pipe, --round-trips=N times (10000).",
+     handoff},
+    {"--false-sharing",
+     "ns per increment and increments/s of 1 to --threads=N threads,\n"
+     "   each incrementing its own counter, counters packed into a cache line\n"
+     "   vs padded to a cache line vs padded to 128 bytes.",
+     false_sharing},
+    {"--contended-mutex",
+     "Mops/s, p50/p99/p99.9 lock() latency and fairness of 1 to\n"
+     "   --threads=N threads doing mutex_access on one std::mutex, with\n"
+     "   --critical-ns and --think-ns of work inside and outside (default:\n"
+     "   0).",
+     contended_mutex},
+    {"--locks",
+     "uncontended ns and contended Mops/s of std::mutex, an adaptive\n"
+     "   pthread mutex, std::shared_mutex, TTAS spinlock, ticket lock and\n"
+     "   MCS lock, threads on one L3 and across sockets (--threads=N).",
+     locks},
+    {"--atomics",
+     "ns (and cycles) of atomic load, store, fetch_add, exchange, CAS and\n"
+     "   128-bit CAS in relaxed, acquire/release, seq_cst orders: on a line\n"
+     "   in L1, on a line another CPU wrote, and by --threads=N at once.",
+     atomics},
+    {"--shootdown",
+     "ns of mmap+touch and of munmap of 4KiB to 16MiB of fresh memory\n"
+     "   while 0 to --threads=N minus one other threads of the process spin\n"
+     "   on other CPUs: the cost of TLB shootdowns.",
+     shootdown},
+    {"--allocators",
+     "ns per allocation and free and peak RSS of glibc malloc/free and\n"
+     "   new/delete vs a bump arena and a fixed-size pool, 16B to 1MiB, from\n"
+     "   one thread and with frees by other threads up to --threads=N.",
+     allocators},
+};
 
 int main(int, char* argv[]) {
   std::signal(SIGINT, deleteme);
@@ -139,6 +4058,9 @@ int main(int, char* argv[]) {
         "(x > 0)`.\n");
     ::printf("mutex_access: latency of `lock(); ++int; unlock();`.\n");
     ::printf("memory_copy_1MiB: latency for copying 1MiB across the RAM.\n");
+    ::printf(
+        "page_fault_4KiB: latency of the first touch of a fresh 4KiB page, "
+        "i.e.\n   fault-in and zeroing, and its share of mmap&munmap.\n");
     ::printf(
         "f{seek,read,write}_..._disk: latency of 1MiB-unit disk IO over a %ld "
         "MiB file.\n",
@@ -148,11 +4070,43 @@ int main(int, char* argv[]) {
     ::printf(
         "numbers [-c|--concise] silences nanobench table of various "
         "metrics.\n");
+    ::printf("\nnumbers MODE runs MODE instead of the above:\n");
+    for (const auto& mode : modes) {
+      ::printf("%s: %s\n", mode.flag, mode.help);
+    }
     ::printf("\nFor more details, read ../notes.md or");
     ::printf(" https://github.com/jaeheum/numbers/blob/main/notes.md\n");
     return EXIT_SUCCESS;
   }
 
+  // warn about --pages, if need be, before any output.
+  pages_param(cmdline);
+  auto ran_modes = false;
+  for (const auto& mode : modes) {
+    if (cmdline[mode.flag]) {
+      try {
+        mode.run(cmdline, outstream);
+      } catch (const std::bad_alloc&) {
+        ::fprintf(stderr, "error: %s ran out of memory or huge pages.\n",
+                  mode.flag);
+        return EXIT_FAILURE;
+      }
+      ran_modes = true;
+    }
+  }
+  if (ran_modes) {
+    return EXIT_SUCCESS;
+  }
+
+  // time spent preparing memory, apart from the measurements.
+  const auto started = std::chrono::steady_clock::now();
+  std::chrono::duration<double> setup_time{0};
+  auto timed = [&](auto&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    setup_time += std::chrono::steady_clock::now() - start;
+  };
+
   ankerl::nanobench::Bench mutex_access;
   mutex_access.name(S(mutex_access)).output(outstream).run([&] {
     m.lock();
@@ -161,30 +4115,16 @@ int main(int, char* argv[]) {
   });
 
   void* dummy;
-  std::vector<void*> memory;
+  chain memory{page_allocator<void*>{pages_param(cmdline)}};
   auto create_random_chain = [&](const size_t limit) {
-    if (limit == 0) {
-      return;
-    }
-    memory.resize(limit / sizeof(void*));
-    for (size_t i = 0; i < memory.size() - 1; ++i) {
-      memory[i] = reinterpret_cast<void*>(&memory[i + 1]);
-    }
-    memory[memory.size() - 1] = reinterpret_cast<void*>(&memory[0]);
-    std::shuffle(memory.begin(), memory.end(),
-                 ankerl::nanobench::Rng{std::random_device{}()});
+    size_t reachable;
+    timed([&] { reachable = ::create_random_chain(memory, limit); });
+    return reachable;
   };
 
-  auto chase_pointers = [&] {
-    auto x = &memory[0];
-    size_t count = memory.size();
-    while (count--) {
-      x = reinterpret_cast<void**>(*x);
-    }
-    dummy = *x;
-  };
+  auto chase_pointers = [&] { dummy = ::chase_pointers(memory); };
 
-  create_random_chain(L1_cache_size);
+  const auto L1_reachable = create_random_chain(L1_cache_size);
   ankerl::nanobench::Bench L1_random_access;
   if (L1_cache_size != 0) {
     L1_random_access.name(S(L1_random_access))
@@ -192,7 +4132,7 @@ int main(int, char* argv[]) {
         .run(chase_pointers);
   }
 
-  create_random_chain(L2_cache_size);
+  const auto L2_reachable = create_random_chain(L2_cache_size);
   ankerl::nanobench::Bench L2_random_access;
   if (L2_cache_size != 0) {
     L2_random_access.name(S(L2_random_access))
@@ -200,7 +4140,7 @@ int main(int, char* argv[]) {
         .run(chase_pointers);
   }
 
-  create_random_chain(L3_cache_size);
+  const auto L3_reachable = create_random_chain(L3_cache_size);
   ankerl::nanobench::Bench L3_random_access;
   if (L3_cache_size != 0) {
     L3_random_access.name(S(L3_random_access))
@@ -208,7 +4148,7 @@ int main(int, char* argv[]) {
         .run(chase_pointers);
   }
 
-  create_random_chain(memory_chunk);
+  const auto memory_reachable = create_random_chain(memory_chunk);
   ankerl::nanobench::Bench memory_random_access;
   memory_random_access.name(S(memory_random_access))
       .epochs(1)
@@ -220,8 +4160,14 @@ int main(int, char* argv[]) {
   // sorted array vs unsorted one. c.f.
   // https://stackoverflow.com/questions/11227809/why-is-it-faster-to-process-a-sorted-array-than-an-unsorted-array
   const auto c = std::max(L3_cache_size, memory_chunk / sizeof(int)); 
-  std::vector<int> vi(c);
-  std::iota(std::begin(vi), std::end(vi), static_cast<int>(-c / 2));
+  std::vector<int, page_allocator<int>> vi;
+  timed([&] {
+    vi.resize(c);
+    in_parallel(c, [&](size_t, const size_t begin, const size_t end) {
+      std::iota(vi.begin() + begin, vi.begin() + end,
+                static_cast<int>(begin - c / 2));
+    });
+  });
   ankerl::nanobench::Bench sorted_memory_branch_mispredictions;
   int y;
   auto positive_only = [&] {
@@ -237,8 +4183,11 @@ int main(int, char* argv[]) {
       .run(positive_only);
 
   ankerl::nanobench::Bench unsorted_memory_branch_mispredictions;
-  std::shuffle(vi.begin(), vi.end(),
-               ankerl::nanobench::Rng{std::random_device{}()});
+  timed([&] {
+    // the same values as the sorted vi, refilled in place in random order.
+    shuffled_fill(vi.data(), c,
+                  [&](const size_t k) { return static_cast<int>(k - c / 2); });
+  });
   unsorted_memory_branch_mispredictions
       .name(S(unsorted_memory_branch_mispredictions))
       .output(outstream)
@@ -254,6 +4203,13 @@ int main(int, char* argv[]) {
     }
   });
 
+  static constexpr size_t fault_bytes = 16 * MiB;
+  ankerl::nanobench::Bench page_fault_4KiB;
+  page_fault_4KiB.name(S(page_fault_4KiB)).output(outstream).run([&] {
+    mapping fresh(fault_bytes, pages::small);
+    touch_pages(fresh.data, fresh.size);
+  });
+
   ankerl::nanobench::Bench fwrite_1MiB_to_disk;
   ankerl::nanobench::Bench fseek_from_disk;
   ankerl::nanobench::Bench fread_1MiB_from_disk;
@@ -299,35 +4255,14 @@ int main(int, char* argv[]) {
         });
   }
 
-  auto v = [](const ankerl::nanobench::Result r, const std::string& s) {
-    return r.fromString(s);
-  };
-
   auto branchmisses = [&](const ankerl::nanobench::Bench& b) {
     auto branchmisses = 0.0;
     for (auto& x : b.results()) {
-      branchmisses += x.median(v(x, "branchmisses"));
+      branchmisses += v(x, "branchmisses");
     }
     return branchmisses / b.results().size();
   };
 
-  auto cpucycles_per_element = [&](const ankerl::nanobench::Bench& b, const size_t element_count) {
-    auto cpucycles = 0.0;
-    for (auto& x : b.results()) {
-      cpucycles += x.median(v(x, "cpucycles"));
-    }
-    return cpucycles / b.results().size() / element_count;
-  };
-
-  auto latency_per_element = [&](const ankerl::nanobench::Bench& b, const size_t element_count) {
-    auto latency = 0.0;
-    for (auto& x : b.results()) {
-      latency += x.median(v(x, "elapsed"));
-    }
-    return latency * std::chrono::nanoseconds(std::chrono::seconds(1)).count() /
-           b.results().size() / element_count;
-  };
-
   auto sorted_branchmisses = branchmisses(sorted_memory_branch_mispredictions);
   auto unsorted_branchmisses =
       branchmisses(unsorted_memory_branch_mispredictions);
@@ -345,8 +4280,6 @@ int main(int, char* argv[]) {
   if (!cmdline[{"-c", "--concise"}]) {
     ::printf("\n");
   }
-  static const char* fmt_ns_cyc = "%-30s %10.1f ns %10.1f cycles\n";
-  static const char* fmt_ns = "%-30s %10.1f ns\n";
 
   static const auto elements_in_L1 = L1_cache_size / sizeof(void*);
   static const auto elements_in_L2 = L2_cache_size / sizeof(void*);
@@ -355,69 +4288,57 @@ int main(int, char* argv[]) {
   static const auto file_size_MiB = fs::file_size(p) / MiB;
   static const auto chars_size_MiB = chars.size() / MiB;
 
+  if (L1_cache_size != 0) {
+    print_ns_cyc(S(L1_random_access),
+                 latency_per_element(L1_random_access, elements_in_L1),
+                 cpucycles_per_element(L1_random_access, elements_in_L1),
+                 L1_reachable);
+  }
+  if (L2_cache_size != 0) {
+    print_ns_cyc(S(L2_random_access),
+                 latency_per_element(L2_random_access, elements_in_L2),
+                 cpucycles_per_element(L2_random_access, elements_in_L2),
+                 L2_reachable);
+  }
+  if (L3_cache_size != 0) {
+    print_ns_cyc(S(L3_random_access),
+                 latency_per_element(L3_random_access, elements_in_L3),
+                 cpucycles_per_element(L3_random_access, elements_in_L3),
+                 L3_reachable);
+  }
+  print_ns_cyc(S(memory_random_access),
+               latency_per_element(memory_random_access, elements_in_memory),
+               cpucycles_per_element(memory_random_access, elements_in_memory),
+               memory_reachable);
+  // skip printing branch_miss_penalty without hardware performance counters
   if (std::isnormal(penalty)) {
-    if (L1_cache_size != 0) {
-      ::printf(fmt_ns_cyc, S(L1_random_access),
-               latency_per_element(L1_random_access, elements_in_L1),
-               cpucycles_per_element(L1_random_access, elements_in_L1));
-    }
-    if (L2_cache_size != 0) { 
-      ::printf(fmt_ns_cyc, S(L2_random_access),
-               latency_per_element(L2_random_access, elements_in_L2),
-               cpucycles_per_element(L2_random_access, elements_in_L2));
-    }
-    if (L3_cache_size != 0) { 
-      ::printf(fmt_ns_cyc, S(L3_random_access),
-               latency_per_element(L3_random_access, elements_in_L3),
-               cpucycles_per_element(L3_random_access, elements_in_L3));
-    }
-    ::printf(fmt_ns_cyc, S(memory_random_access),
-             latency_per_element(memory_random_access, elements_in_memory),
-             cpucycles_per_element(memory_random_access, elements_in_memory));
-    ::printf(fmt_ns_cyc, S(branch_miss_penalty), penalty, penalty_cycles);
-    ::printf(fmt_ns_cyc, S(mutex_access), latency_per_element(mutex_access, 1UL),
-             cpucycles_per_element(mutex_access, 1UL));
-    ::printf(fmt_ns_cyc, S(memory_copy_1MiB),
-             latency_per_element(memory_copy_1MiB, chars_size_MiB),
-             cpucycles_per_element(memory_copy_1MiB, chars_size_MiB));
-    if (si.available > memory_chunk) {
-      ::printf(fmt_ns_cyc, S(fseek_from_disk),
-               latency_per_element(fseek_from_disk, file_size_MiB),
-               cpucycles_per_element(fseek_from_disk, file_size_MiB));
-      ::printf(fmt_ns_cyc, S(fread_1MiB_from_disk),
-               latency_per_element(fread_1MiB_from_disk, file_size_MiB),
-               cpucycles_per_element(fread_1MiB_from_disk, file_size_MiB));
-      ::printf(fmt_ns_cyc, S(fwrite_1MiB_to_disk),
-               latency_per_element(fwrite_1MiB_to_disk, file_size_MiB),
-               cpucycles_per_element(fwrite_1MiB_to_disk, file_size_MiB));
-    }
-  } else {
-    if (L1_cache_size != 0) { 
-      ::printf(fmt_ns, S(L1_random_access),
-               latency_per_element(L1_random_access, elements_in_L1));
-    }
-    if (L2_cache_size != 0) { 
-      ::printf(fmt_ns, S(L2_random_access),
-               latency_per_element(L2_random_access, elements_in_L2));
-    }
-    if (L3_cache_size != 0) { 
-      ::printf(fmt_ns, S(L3_random_access),
-               latency_per_element(L3_random_access, elements_in_L3));
-    }
-    ::printf(fmt_ns, S(memory_random_access),
-             latency_per_element(memory_random_access, elements_in_memory));
-    // skip printing branch_miss_penalty
-    ::printf(fmt_ns, S(mutex_access), latency_per_element(mutex_access, 1UL));
-    ::printf(fmt_ns, S(memory_copy_1MiB),
-             latency_per_element(memory_copy_1MiB, chars_size_MiB));
-    if (si.available > memory_chunk) {
-      ::printf(fmt_ns, S(fseek_from_disk),
-              latency_per_element(fseek_from_disk, file_size_MiB));
-      ::printf(fmt_ns, S(fread_1MiB_from_disk),
-               latency_per_element(fread_1MiB_from_disk, file_size_MiB));
-      ::printf(fmt_ns, S(fwrite_1MiB_to_disk),
-               latency_per_element(fwrite_1MiB_to_disk, file_size_MiB));
-    }
+    print_ns_cyc(S(branch_miss_penalty), penalty, penalty_cycles);
+  }
+  print_ns_cyc(S(mutex_access), latency_per_element(mutex_access, 1UL),
+               cpucycles_per_element(mutex_access, 1UL));
+  print_ns_cyc(S(memory_copy_1MiB),
+               latency_per_element(memory_copy_1MiB, chars_size_MiB),
+               cpucycles_per_element(memory_copy_1MiB, chars_size_MiB));
+  // per 4KiB, as named, whatever the system page size.
+  static constexpr size_t fault_4KiBs = fault_bytes / (4 * KiB);
+  print_ns_cyc(S(page_fault_4KiB),
+               latency_per_element(page_fault_4KiB, fault_4KiBs),
+               cpucycles_per_element(page_fault_4KiB, fault_4KiBs));
+  if (si.available > memory_chunk) {
+    print_ns_cyc(S(fseek_from_disk),
+                 latency_per_element(fseek_from_disk, file_size_MiB),
+                 cpucycles_per_element(fseek_from_disk, file_size_MiB));
+    print_ns_cyc(S(fread_1MiB_from_disk),
+                 latency_per_element(fread_1MiB_from_disk, file_size_MiB),
+                 cpucycles_per_element(fread_1MiB_from_disk, file_size_MiB));
+    print_ns_cyc(S(fwrite_1MiB_to_disk),
+                 latency_per_element(fwrite_1MiB_to_disk, file_size_MiB),
+                 cpucycles_per_element(fwrite_1MiB_to_disk, file_size_MiB));
   }
+  const std::chrono::duration<double> total =
+      std::chrono::steady_clock::now() - started;
+  ::printf("(setup %.1f s on %zu cpus, measurements %.1f s.)\n",
+           setup_time.count(), setup_cpus().size(),
+           (total - setup_time).count());
   return EXIT_SUCCESS;
 }